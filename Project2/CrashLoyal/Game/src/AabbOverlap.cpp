@@ -0,0 +1,291 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "AabbOverlap.h"
+
+#include <assert.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CRASHLOYAL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC lets any function use any instruction set's intrinsics.  GCC and Clang
+//  have to be told which functions are allowed to.
+#if defined(CRASHLOYAL_X86) && !defined(_MSC_VER)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX __attribute__((target("avx")))
+#else
+#define TARGET_SSE2
+#define TARGET_AVX
+#endif
+
+typedef unsigned int (*OverlapFunc)(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                                    float x, float y, float halfSize, unsigned int* pHits);
+
+// Tests squares [begin, end), and adds their hits after the numHits that we
+//  already have.  Returns the new number of hits.
+static inline unsigned int findOverlapsInRange(const float* pXs, const float* pYs, const float* pHalfSizes,
+                                               unsigned int begin, unsigned int end,
+                                               float x, float y, float halfSize, 
+                                               unsigned int* pHits, unsigned int numHits)
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        if (aabbOverlaps(pXs[i], pYs[i], pHalfSizes[i], x, y, halfSize))
+        {
+            pHits[numHits++] = i;
+        }
+    }
+    return numHits;
+}
+
+static unsigned int findOverlapsScalar(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                                       float x, float y, float halfSize, unsigned int* pHits)
+{
+    return findOverlapsInRange(pXs, pYs, pHalfSizes, 0, count, x, y, halfSize, pHits, 0);
+}
+
+#ifdef CRASHLOYAL_X86
+
+// Returns the index of the lowest bit that's set (mask mustn't be zero).
+static inline unsigned int getLowestBit(unsigned int mask)
+{
+    assert(mask != 0);
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return (unsigned int)bit;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+// Adds index + b to the hits for each bit b that's set in mask.  Most squares
+//  miss, so most masks are zero and this costs next to nothing.
+static inline unsigned int appendHits(unsigned int mask, unsigned int index, unsigned int* pHits, unsigned int numHits)
+{
+    while (mask != 0)
+    {
+        pHits[numHits++] = index + getLowestBit(mask);
+        mask &= mask - 1;
+    }
+    return numHits;
+}
+
+TARGET_SSE2
+static unsigned int findOverlapsSse2(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                                     float x, float y, float halfSize, unsigned int* pHits)
+{
+    // NOTE: These are the same sums that aabbOverlaps() does, just done once
+    //  rather than once per square, so the comparisons come out the same.
+    const __m128 minX = _mm_set1_ps(x - halfSize);
+    const __m128 maxX = _mm_set1_ps(x + halfSize);
+    const __m128 minY = _mm_set1_ps(y - halfSize);
+    const __m128 maxY = _mm_set1_ps(y + halfSize);
+
+    unsigned int numHits = 0;
+    unsigned int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 xs = _mm_loadu_ps(pXs + i);
+        const __m128 ys = _mm_loadu_ps(pYs + i);
+        const __m128 halfSizes = _mm_loadu_ps(pHalfSizes + i);
+
+        __m128 hit = _mm_cmpge_ps(_mm_add_ps(xs, halfSizes), minX);
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_sub_ps(xs, halfSizes), maxX));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(_mm_add_ps(ys, halfSizes), minY));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_sub_ps(ys, halfSizes), maxY));
+
+        numHits = appendHits((unsigned int)_mm_movemask_ps(hit), i, pHits, numHits);
+    }
+
+    return findOverlapsInRange(pXs, pYs, pHalfSizes, i, count, x, y, halfSize, pHits, numHits);
+}
+
+TARGET_AVX
+static unsigned int findOverlapsAvx(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                                    float x, float y, float halfSize, unsigned int* pHits)
+{
+    const __m256 minX = _mm256_set1_ps(x - halfSize);
+    const __m256 maxX = _mm256_set1_ps(x + halfSize);
+    const __m256 minY = _mm256_set1_ps(y - halfSize);
+    const __m256 maxY = _mm256_set1_ps(y + halfSize);
+
+    unsigned int numHits = 0;
+    unsigned int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 xs = _mm256_loadu_ps(pXs + i);
+        const __m256 ys = _mm256_loadu_ps(pYs + i);
+        const __m256 halfSizes = _mm256_loadu_ps(pHalfSizes + i);
+
+        // NOTE: The ordered compares are false for NaN, like the scalar ones.
+        __m256 hit = _mm256_cmp_ps(_mm256_add_ps(xs, halfSizes), minX, _CMP_GE_OQ);
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_sub_ps(xs, halfSizes), maxX, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(ys, halfSizes), minY, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_sub_ps(ys, halfSizes), maxY, _CMP_LE_OQ));
+
+        numHits = appendHits((unsigned int)_mm256_movemask_ps(hit), i, pHits, numHits);
+    }
+
+    return findOverlapsInRange(pXs, pYs, pHalfSizes, i, count, x, y, halfSize, pHits, numHits);
+}
+
+static void getCpuId(int leaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, leaf);
+    for (int i = 0; i < 4; ++i)
+    {
+        regs[i] = (unsigned int)info[i];
+    }
+#else
+    __cpuid(leaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static bool cpuHasSse2()
+{
+    unsigned int regs[4];
+    getCpuId(1, regs);
+    return (regs[3] & (1u << 26)) != 0;
+}
+
+static bool cpuHasAvx()
+{
+    // The CPU has to support it, and so does the OS (it has to save the 
+    //  wider registers when it switches threads).
+    unsigned int regs[4];
+    getCpuId(1, regs);
+    const bool bOsSaves = (regs[2] & (1u << 27)) != 0;
+    const bool bAvx = (regs[2] & (1u << 28)) != 0;
+    if (!bOsSaves || !bAvx)
+    {
+        return false;
+    }
+
+#if defined(_MSC_VER)
+    const unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    const unsigned long long xcr0 = ((unsigned long long)edx << 32) | eax;
+#endif
+    return (xcr0 & 6) == 6;
+}
+
+#endif // CRASHLOYAL_X86
+
+static OverlapFunc getOverlapFunc(OverlapKernel kernel)
+{
+    switch (kernel)
+    {
+#ifdef CRASHLOYAL_X86
+    case Sse2OverlapKernel:     return &findOverlapsSse2;
+    case AvxOverlapKernel:      return &findOverlapsAvx;
+#endif
+    default:                    return &findOverlapsScalar;
+    }
+}
+
+static bool checkOverlapKernelSupported(OverlapKernel kernel)
+{
+    switch (kernel)
+    {
+    case ScalarOverlapKernel:
+        return true;
+#ifdef CRASHLOYAL_X86
+    case Sse2OverlapKernel:
+        return cpuHasSse2();
+    case AvxOverlapKernel:
+        return cpuHasAvx();
+#endif
+    default:
+        return false;
+    }
+}
+
+// Asking the CPU is slow (especially in a virtual machine), so we only ask 
+//  once, before main() starts.
+struct OverlapKernels
+{
+    OverlapKernels()
+        : m_Best(ScalarOverlapKernel)
+    {
+        for (int kernel = 0; kernel < NumOverlapKernels; ++kernel)
+        {
+            m_bSupported[kernel] = checkOverlapKernelSupported((OverlapKernel)kernel);
+            if (m_bSupported[kernel])
+            {
+                m_Best = (OverlapKernel)kernel;
+            }
+        }
+        m_pBestFunc = getOverlapFunc(m_Best);
+    }
+
+    bool m_bSupported[NumOverlapKernels];
+    OverlapKernel m_Best;
+    OverlapFunc m_pBestFunc;
+};
+static const OverlapKernels ksKernels;
+
+const char* getOverlapKernelName(OverlapKernel kernel)
+{
+    switch (kernel)
+    {
+    case ScalarOverlapKernel:   return "Scalar";
+    case Sse2OverlapKernel:     return "SSE2";
+    case AvxOverlapKernel:      return "AVX";
+    default:                    return "Unknown";
+    }
+}
+
+bool isOverlapKernelSupported(OverlapKernel kernel)
+{
+    return (kernel < NumOverlapKernels) && ksKernels.m_bSupported[kernel];
+}
+
+OverlapKernel getBestOverlapKernel()
+{
+    return ksKernels.m_Best;
+}
+
+unsigned int findAabbOverlaps(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                              float x, float y, float halfSize, unsigned int* pHits)
+{
+    return ksKernels.m_pBestFunc(pXs, pYs, pHalfSizes, count, x, y, halfSize, pHits);
+}
+
+unsigned int findAabbOverlaps(OverlapKernel kernel,
+                              const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                              float x, float y, float halfSize, unsigned int* pHits)
+{
+    assert(isOverlapKernelSupported(kernel));
+    return getOverlapFunc(kernel)(pXs, pYs, pHalfSizes, count, x, y, halfSize, pHits);
+}
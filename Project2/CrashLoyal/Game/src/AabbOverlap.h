@@ -0,0 +1,77 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Vec2.h"
+
+// Overlap tests between axis aligned squares (every mob and building is one),
+// given by their centers and half sizes.  Touching counts as overlapping.
+//
+// NOTE: The tests aren't quite symmetric.  Floating point rounding means that
+// (x0 + h0 >= x1 - h1) isn't always the same as (x1 + h1 >= x0 - h0), so to 
+// get the same answer everywhere, the other square always comes first and 
+// the one doing the asking (the mob that's moving) comes second.
+inline bool aabbOverlaps(float x0, float y0, float halfSize0, float x1, float y1, float halfSize1)
+{
+    return ((x0 + halfSize0) >= (x1 - halfSize1))
+        && ((x0 - halfSize0) <= (x1 + halfSize1))
+        && ((y0 + halfSize0) >= (y1 - halfSize1))
+        && ((y0 - halfSize0) <= (y1 + halfSize1));
+}
+
+inline bool aabbOverlaps(const Vec2& pos0, float halfSize0, const Vec2& pos1, float halfSize1)
+{
+    return aabbOverlaps(pos0.x, pos0.y, halfSize0, pos1.x, pos1.y, halfSize1);
+}
+
+// The ways that findAabbOverlaps() can do its work.  They all give exactly 
+// the same answers as aabbOverlaps(); the vector ones just test 4 or 8 
+// squares at a time.
+enum OverlapKernel
+{
+    ScalarOverlapKernel,
+    Sse2OverlapKernel,
+    AvxOverlapKernel,
+
+    NumOverlapKernels
+};
+
+const char* getOverlapKernelName(OverlapKernel kernel);
+
+// Whether this build and this CPU can run the kernel.  The scalar one always
+//  can.
+bool isOverlapKernelSupported(OverlapKernel kernel);
+
+// The fastest kernel that's supported, which is what findAabbOverlaps() uses
+//  unless it's told otherwise.
+OverlapKernel getBestOverlapKernel();
+
+// Tests the square at (x, y) against count others, whose centers and half 
+//  sizes are in the given arrays, and writes the index of each one that it 
+//  overlaps to pHits, in order.  Returns how many it found.  pHits needs room
+//  for count indices.
+unsigned int findAabbOverlaps(const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                              float x, float y, float halfSize, unsigned int* pHits);
+unsigned int findAabbOverlaps(OverlapKernel kernel,
+                              const float* pXs, const float* pYs, const float* pHalfSizes, unsigned int count,
+                              float x, float y, float halfSize, unsigned int* pHits);
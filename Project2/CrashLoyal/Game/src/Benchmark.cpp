@@ -0,0 +1,401 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmark.h"
+
+#include "AabbOverlap.h"
+#include "Constants.h"
+#include "Game.h"
+#include "Headless.h"
+#include "Player.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// How many squares each test looks at.  The small ones are the size of a row
+//  of broadphase cells around a mob in a crowd; the big ones show what the 
+//  kernels can do with nothing else in the way.
+static const unsigned int ksBatchSizes[] = { 8, 32, 128, 1024 };
+
+// Every batch gets tested this many times, against different squares.
+static const unsigned int ksNumQueries = 256;
+
+// Each kernel is timed for at least this many square tests per batch size.
+static const unsigned long long ksMinTestsPerKernel = 20000000;
+
+struct OverlapBatch
+{
+    std::vector<float> m_Xs;
+    std::vector<float> m_Ys;
+    std::vector<float> m_HalfSizes;
+    std::vector<float> m_QueryXs;
+    std::vector<float> m_QueryYs;
+    std::vector<float> m_QueryHalfSizes;
+};
+
+static void makeBatch(unsigned int count, std::mt19937& random, OverlapBatch& batch)
+{
+    // A crowd of mob sized squares in a few meters of arena, so that some 
+    //  of them overlap each query and most of them don't.
+    std::uniform_real_distribution<float> position(0.f, 4.f);
+    std::uniform_real_distribution<float> halfSize(0.15f, 0.5f);
+
+    batch = OverlapBatch();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        batch.m_Xs.push_back(position(random));
+        batch.m_Ys.push_back(position(random));
+        batch.m_HalfSizes.push_back(halfSize(random));
+    }
+    for (unsigned int i = 0; i < ksNumQueries; ++i)
+    {
+        batch.m_QueryXs.push_back(position(random));
+        batch.m_QueryYs.push_back(position(random));
+        batch.m_QueryHalfSizes.push_back(halfSize(random));
+    }
+}
+
+// Runs every query against the batch, and returns how many hits there were.
+static unsigned long long runQueries(OverlapKernel kernel, const OverlapBatch& batch, std::vector<unsigned int>& hits)
+{
+    const unsigned int count = (unsigned int)batch.m_Xs.size();
+    unsigned long long numHits = 0;
+    for (unsigned int q = 0; q < ksNumQueries; ++q)
+    {
+        numHits += findAabbOverlaps(kernel, batch.m_Xs.data(), batch.m_Ys.data(), batch.m_HalfSizes.data(), count,
+                                    batch.m_QueryXs[q], batch.m_QueryYs[q], batch.m_QueryHalfSizes[q], hits.data());
+    }
+    return numHits;
+}
+
+// Checks the kernel against the scalar one, query by query.
+static bool checkKernel(OverlapKernel kernel, const OverlapBatch& batch)
+{
+    const unsigned int count = (unsigned int)batch.m_Xs.size();
+    std::vector<unsigned int> expected(count);
+    std::vector<unsigned int> actual(count);
+    for (unsigned int q = 0; q < ksNumQueries; ++q)
+    {
+        const unsigned int numExpected = findAabbOverlaps(ScalarOverlapKernel, 
+            batch.m_Xs.data(), batch.m_Ys.data(), batch.m_HalfSizes.data(), count,
+            batch.m_QueryXs[q], batch.m_QueryYs[q], batch.m_QueryHalfSizes[q], expected.data());
+        const unsigned int numActual = findAabbOverlaps(kernel, 
+            batch.m_Xs.data(), batch.m_Ys.data(), batch.m_HalfSizes.data(), count,
+            batch.m_QueryXs[q], batch.m_QueryYs[q], batch.m_QueryHalfSizes[q], actual.data());
+
+        if ((numActual != numExpected) || !std::equal(expected.begin(), expected.begin() + numExpected, actual.begin()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runOverlapBenchmark(std::ostream& out)
+{
+    using namespace std::chrono;
+
+    const std::ios::fmtflags oldFlags = out.flags();
+    const std::streamsize oldPrecision = out.precision();
+
+    out << "AABB overlap kernels (best supported: " << getOverlapKernelName(getBestOverlapKernel()) << ")" << std::endl;
+    out << "  " << std::left << std::setw(8) << "squares" << std::setw(8) << "kernel"
+        << std::right << std::setw(12) << "ns/square" << std::setw(10) << "speedup" << std::setw(10) << "hits" << std::endl;
+
+    std::mt19937 random(12345);
+    bool bAllMatch = true;
+    for (unsigned int batchSize : ksBatchSizes)
+    {
+        OverlapBatch batch;
+        makeBatch(batchSize, random, batch);
+        std::vector<unsigned int> hits(batchSize);
+
+        const unsigned long long testsPerPass = (unsigned long long)batchSize * ksNumQueries;
+        const unsigned int numPasses = (unsigned int)((ksMinTestsPerKernel + testsPerPass - 1) / testsPerPass);
+
+        double scalarNs = 0.0;
+        for (int k = 0; k < NumOverlapKernels; ++k)
+        {
+            const OverlapKernel kernel = (OverlapKernel)k;
+            if (!isOverlapKernelSupported(kernel))
+            {
+                continue;
+            }
+
+            const bool bMatches = checkKernel(kernel, batch);
+            bAllMatch = bAllMatch && bMatches;
+
+            unsigned long long numHits = 0;
+            const high_resolution_clock::time_point start = high_resolution_clock::now();
+            for (unsigned int pass = 0; pass < numPasses; ++pass)
+            {
+                numHits += runQueries(kernel, batch, hits);
+            }
+            const double sec = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+            const double nsPerSquare = (sec * 1e9) / ((double)testsPerPass * numPasses);
+            if (kernel == ScalarOverlapKernel)
+            {
+                scalarNs = nsPerSquare;
+            }
+
+            out << "  " << std::left << std::setw(8) << batchSize << std::setw(8) << getOverlapKernelName(kernel)
+                << std::right << std::fixed << std::setprecision(3) << std::setw(12) << nsPerSquare
+                << std::setprecision(2) << std::setw(9) << (scalarNs / nsPerSquare) << "x"
+                << std::setw(10) << (numHits / numPasses)
+                << (bMatches ? "" : "  MISMATCH") << std::endl;
+        }
+    }
+
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+    return bAllMatch;
+}
+
+// How many mobs each side starts the snapshot benchmark with
+static const unsigned int ksSnapshotMobsPerSide = 100;
+
+// Ticks between the snapshot and the checks, so that there's something to undo
+static const unsigned int ksSnapshotCheckTicks = 20;
+
+static const unsigned int ksSnapshotPasses = 10000;
+
+static bool isSameSnapshot(const Snapshot& a, const Snapshot& b)
+{
+    return (a.getSize() == b.getSize()) && (memcmp(a.getData(), b.getData(), a.getSize()) == 0);
+}
+
+bool runSnapshotBenchmark(std::ostream& out)
+{
+    using namespace std::chrono;
+
+    const std::ios::fmtflags oldFlags = out.flags();
+    const std::streamsize oldPrecision = out.precision();
+
+    // Spread the mobs over each side's half of the arena, and let them tick
+    //  for a bit so that they have targets, velocities and so on.
+    Game* pGame = new Game(NULL, NULL);
+    Game& game = *pGame;
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<float> x(0.5f, GAME_GRID_WIDTH - 0.5f);
+    std::uniform_real_distribution<float> y(0.5f, RIVER_TOP_Y - 1.f);
+    for (bool bNorth : { true, false })
+    {
+        EntityStore& mobs = game.getPlayer(bNorth).getMobs();
+        for (unsigned int i = 0; i < ksSnapshotMobsPerSide; ++i)
+        {
+            const iEntityStats::MobType type = (iEntityStats::MobType)(i % iEntityStats::numMobTypes);
+            mobs.add(iEntityStats::getStats(type), Vec2(x(random), y(random)).Player2Game(bNorth));
+        }
+    }
+    for (unsigned int t = 0; t < ksSnapshotCheckTicks; ++t)
+    {
+        game.tick(1.f / SIM_HZ);
+    }
+
+    // Restoring has to put back exactly what was saved, and ticking from 
+    //  there has to go the same way it did the first time.
+    Snapshot snapshot;
+    game.saveSnapshot(snapshot);
+    const unsigned long long savedHash = game.computeStateHash();
+    for (unsigned int t = 0; t < ksSnapshotCheckTicks; ++t)
+    {
+        game.tick(1.f / SIM_HZ);
+    }
+    const unsigned long long tickedHash = game.computeStateHash();
+
+    Snapshot restored;
+    bool bOk = game.restoreSnapshot(snapshot);
+    game.saveSnapshot(restored);
+    bOk = bOk && (game.computeStateHash() == savedHash) && isSameSnapshot(snapshot, restored);
+    for (unsigned int t = 0; t < ksSnapshotCheckTicks; ++t)
+    {
+        game.tick(1.f / SIM_HZ);
+    }
+    bOk = bOk && (game.computeStateHash() == tickedHash);
+
+    // Now time them, against the state we saved.
+    game.restoreSnapshot(snapshot);
+    const unsigned int numMobs = game.getPlayer(true).getNumMobs() + game.getPlayer(false).getNumMobs();
+
+    high_resolution_clock::time_point start = high_resolution_clock::now();
+    for (unsigned int pass = 0; pass < ksSnapshotPasses; ++pass)
+    {
+        game.saveSnapshot(restored);
+    }
+    const double saveSec = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+    start = high_resolution_clock::now();
+    for (unsigned int pass = 0; pass < ksSnapshotPasses; ++pass)
+    {
+        bOk = game.restoreSnapshot(snapshot) && bOk;
+    }
+    const double restoreSec = duration_cast<duration<double>>(high_resolution_clock::now() - start).count();
+
+    out << "Game snapshots (" << numMobs << " mobs, " << snapshot.getSize() << " bytes)" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    out << "  save:     " << std::setw(8) << (saveSec * 1e6 / ksSnapshotPasses) << " us" << std::endl;
+    out << "  restore:  " << std::setw(8) << (restoreSec * 1e6 / ksSnapshotPasses) << " us" << std::endl;
+    out << "  round trip " << (bOk ? "matches" : "MISMATCH") << std::endl;
+
+    delete pGame;
+
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+    return bOk;
+}
+
+// The synthetic battles for runSimBenchmark()
+struct SimScenario
+{
+    const char* m_pName;
+    bool m_bClustered;      // in a crowd at the bridge, rather than spread over the lane
+    bool m_bBothLanes;
+};
+
+static const SimScenario ksSimScenarios[] =
+{
+    { "clustered_one_lane", true, false },
+    { "clustered_both_lanes", true, true },
+    { "spread_one_lane", false, false },
+    { "spread_both_lanes", false, true },
+};
+
+static const unsigned int ksSimMobCounts[] = { 10, 100, 1000, 10000, 100000 };
+
+static const unsigned int ksSimWarmupTicks = 2;
+
+// Enough ticks to time the small battles properly, without the big ones 
+//  taking all day.
+static unsigned int getSimTicks(unsigned int numMobs)
+{
+    return std::max(5u, std::min(200u, 200000u / numMobs));
+}
+
+static void placeSimMobs(Game& game, const SimScenario& scenario, unsigned int numMobs)
+{
+    std::mt19937 random(12345);
+    std::normal_distribution<float> crowd(0.f, 1.5f);
+    std::uniform_real_distribution<float> spreadX(0.5f, (GAME_GRID_WIDTH / 2) - 0.5f);
+    std::uniform_real_distribution<float> spreadY(0.5f, RIVER_TOP_Y - 0.5f);
+
+    for (bool bNorth : { true, false })
+    {
+        EntityStore& mobs = game.getPlayer(bNorth).getMobs();
+        const unsigned int numSideMobs = bNorth ? ((numMobs + 1) / 2) : (numMobs / 2);
+        mobs.reserve(numSideMobs);
+
+        for (unsigned int i = 0; i < numSideMobs; ++i)
+        {
+            // Positions are picked as if we were North, and then flipped.
+            const bool bRightLane = scenario.m_bBothLanes && ((i % 2) == 1);
+            Vec2 pos;
+            if (scenario.m_bClustered)
+            {
+                pos.x = LEFT_BRIDGE_CENTER_X + crowd(random);
+                pos.y = RIVER_TOP_Y - 2.f + crowd(random);
+            }
+            else
+            {
+                pos.x = spreadX(random);
+                pos.y = spreadY(random);
+            }
+            if (bRightLane)
+            {
+                pos.x = GAME_GRID_WIDTH - pos.x;
+            }
+            pos.x = std::max(0.5f, std::min(GAME_GRID_WIDTH - 0.5f, pos.x));
+            pos.y = std::max(0.5f, std::min(RIVER_TOP_Y - 0.5f, pos.y));
+
+            const iEntityStats::MobType type = (iEntityStats::MobType)(i % iEntityStats::numMobTypes);
+            mobs.add(iEntityStats::getStats(type), pos.Player2Game(bNorth));
+        }
+    }
+}
+
+void runSimBenchmark(std::ostream& out, unsigned int maxMobs, unsigned int numThreads)
+{
+    using namespace std::chrono;
+
+    bool bWroteHeader = false;
+    for (const SimScenario& scenario : ksSimScenarios)
+    {
+        for (unsigned int numMobs : ksSimMobCounts)
+        {
+            if (numMobs > maxMobs)
+                continue;
+
+            Game game(NULL, NULL, numThreads);
+            placeSimMobs(game, scenario, numMobs);
+            game.reserve(numMobs);
+
+            const float deltaTSec = 1.f / SIM_HZ;
+            for (unsigned int t = 0; t < ksSimWarmupTicks; ++t)
+            {
+                game.tick(deltaTSec);
+            }
+
+            const PhaseGraph& graph = game.getTickGraph();
+            if (!bWroteHeader)
+            {
+                out << "scenario\tmobs\tthreads\tticks\tns_per_mob_tick";
+                for (unsigned int p = 0; p < graph.getNumPhases(); ++p)
+                {
+                    out << "\t" << graph.getName(p) << "_ns_per_mob_tick";
+                }
+                out << "\tallocs_per_tick\tmobs_left" << std::endl;
+                bWroteHeader = true;
+            }
+
+            // Busy time, summed over every thread, for each phase.
+            double phaseSec[PhaseGraph::ksMaxPhases] = {};
+            const unsigned int numTicks = getSimTicks(numMobs);
+            const unsigned long long startAllocs = getNumHeapAllocs();
+            const high_resolution_clock::time_point startTime = high_resolution_clock::now();
+            for (unsigned int t = 0; t < numTicks; ++t)
+            {
+                game.tick(deltaTSec);
+                for (unsigned int p = 0; p < graph.getNumPhases(); ++p)
+                {
+                    phaseSec[p] += graph.getLastTiming(p).m_Busy;
+                }
+            }
+            const double sec = duration_cast<duration<double>>(high_resolution_clock::now() - startTime).count();
+            const unsigned long long numAllocs = getNumHeapAllocs() - startAllocs;
+
+            const double perMobTick = 1e9 / ((double)numMobs * numTicks);
+            out << scenario.m_pName << "\t" << numMobs << "\t" << game.getNumThreads() << "\t" << numTicks
+                << "\t" << (sec * perMobTick);
+            for (unsigned int p = 0; p < graph.getNumPhases(); ++p)
+            {
+                out << "\t" << (phaseSec[p] * perMobTick);
+            }
+            out << "\t" << ((double)numAllocs / numTicks)
+                << "\t" << (game.getPlayer(true).getNumMobs() + game.getPlayer(false).getNumMobs()) << std::endl;
+        }
+    }
+}
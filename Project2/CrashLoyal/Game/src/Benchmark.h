@@ -0,0 +1,48 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>
+
+// Microbenchmarks for the simulation's inner loops.  They print their results
+// to out.
+
+// Times each supported findAabbOverlaps() kernel against batches of squares
+//  of a few different sizes, after checking that they all find exactly the 
+//  same overlaps as the scalar one.  Returns false if they didn't.
+bool runOverlapBenchmark(std::ostream& out);
+
+// Times Game::saveSnapshot() and restoreSnapshot() on a new game with a few 
+//  hundred mobs in it, after checking that restoring puts back exactly what 
+//  was saved, and that the game ticks on the same way afterward.  Returns 
+//  false if it didn't.
+bool runSnapshotBenchmark(std::ostream& out);
+
+// Ticks synthetic battles of 10 to maxMobs mobs (clustered or spread out, in
+//  one lane or both), and writes a line for each one to out, as tab 
+//  separated columns with a header line.  The columns are the time per mob 
+//  per tick, for the whole tick and for each of its phases, and the heap 
+//  allocations per tick.  The mobs are placed the same way every time, and
+//  each battle runs for a fixed number of ticks, so the results can be 
+//  compared from one build to the next.
+void runSimBenchmark(std::ostream& out, unsigned int maxMobs, unsigned int numThreads);
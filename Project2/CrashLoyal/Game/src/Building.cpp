@@ -22,8 +22,8 @@
 
 #include "Building.h"
 
-Building::Building(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-    : Entity(stats, pos, isNorth)
+Building::Building(EntityStore& store, unsigned int index)
+    : Entity(store, index)
 {
-    assert(dynamic_cast<const iEntityStats_Building*>(&stats) != NULL);
+    assert(store.holdsBuildings());
 }
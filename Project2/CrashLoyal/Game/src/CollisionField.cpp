@@ -0,0 +1,294 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "CollisionField.h"
+
+#include "AabbOverlap.h"
+#include "Constants.h"
+#include "EntityStatTable.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cfloat>
+
+// NOTE: The cell size has to divide 1 exactly, so that every edge in 
+//  Constants.h falls on a cell edge and finding a cell doesn't round.
+static const float ksCellSize = 0.5f;
+static const float ksInvCellSize = 1.f / ksCellSize;
+
+// Every tower gets a bit in the masks.
+static const unsigned int ksMaxTowers = sizeof(unsigned short) * 8;
+
+// Pads the towers when deciding which cells they might reach, to cover any
+//  float error in the exact test.
+static const float ksTowerSlop = 0.01f;
+
+// The stretches of river that a mob can't walk in, and which way each one 
+//  pushes.  The gaps between them are the bridges.
+// NOTE: The gaps are half a meter to the left of where the bridges are 
+//  drawn, and the last stretch runs off the right edge of the map.  That's
+//  where the collision code has always had them.
+struct RiverSpan
+{
+    float m_MinX;
+    float m_MaxX;
+    CollisionField::RiverPush m_Push;
+};
+
+static const RiverSpan ksRiverSpans[] =
+{
+    { RIVER_LEFT_X, LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.f, CollisionField::RiverPushRight },
+    { RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.f - 0.5f, FLT_MAX, CollisionField::RiverPushLeft },
+    { LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.f - 0.5f, RIGHT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.f - 0.5f, CollisionField::RiverPushLeft },
+};
+
+static bool overlapsSpan(const RiverSpan& span, const Vec2& minPt, const Vec2& maxPt)
+{
+    return (maxPt.x >= span.m_MinX) && (minPt.x <= span.m_MaxX)
+        && (maxPt.y >= RIVER_TOP_Y) && (minPt.y <= RIVER_BOT_Y);
+}
+
+static CollisionField::RiverPush getExactRiverPush(const Vec2& pos)
+{
+    if ((pos.y < RIVER_TOP_Y) || (pos.y > RIVER_BOT_Y))
+    {
+        return CollisionField::RiverNone;
+    }
+
+    for (const RiverSpan& span : ksRiverSpans)
+    {
+        if ((pos.x >= span.m_MinX) && (pos.x <= span.m_MaxX))
+        {
+            return span.m_Push;
+        }
+    }
+
+    return CollisionField::RiverNone;
+}
+
+CollisionField::CollisionField()
+    : m_NumCellsX((int)(GAME_GRID_WIDTH * ksInvCellSize))
+    , m_NumCellsY((int)(GAME_GRID_HEIGHT * ksInvCellSize))
+{
+    const int numCells = m_NumCellsX * m_NumCellsY;
+    m_River.resize(numCells);
+    m_TowerMasks.resize(numCells * iEntityStats::numMobTypes);
+    m_Towers.reserve(ksMaxTowers);
+
+    buildRiver();
+}
+
+void CollisionField::build(const EntityStore& northBuildings, const EntityStore& southBuildings)
+{
+    m_Towers.clear();
+    addTowers(northBuildings);
+    addTowers(southBuildings);
+
+    buildTowerMasks();
+}
+
+void CollisionField::addTowers(const EntityStore& buildings)
+{
+    assert(buildings.holdsBuildings());
+    for (unsigned int i = 0; i < buildings.size(); ++i)
+    {
+        if (buildings.isDead(i))
+        {
+            continue;
+        }
+
+        Tower tower;
+        tower.m_Pos = buildings.m_Pos[i];
+        tower.m_HalfSize = buildings.getStatRow(i).m_HalfSize;
+
+        assert(m_Towers.size() < ksMaxTowers);
+        m_Towers.push_back(tower);
+    }
+}
+
+void CollisionField::buildRiver()
+{
+    // A cell is in (or out of) a stretch of river only if all of it is, 
+    //  edges included - anything else is marked as an edge cell, and gets 
+    //  the exact test.
+    for (int y = 0; y < m_NumCellsY; ++y)
+    {
+        const float minY = (float)y * ksCellSize;
+        const float maxY = minY + ksCellSize;
+        for (int x = 0; x < m_NumCellsX; ++x)
+        {
+            const float minX = (float)x * ksCellSize;
+            const float maxX = minX + ksCellSize;
+
+            RiverCell cell = RiverCellNone;
+            for (const RiverSpan& span : ksRiverSpans)
+            {
+                const bool bInside = (minX >= span.m_MinX) && (maxX <= span.m_MaxX)
+                    && (minY >= RIVER_TOP_Y) && (maxY <= RIVER_BOT_Y);
+
+                if (bInside)
+                {
+                    cell = (RiverCell)span.m_Push;
+                    break;
+                }
+                if (overlapsSpan(span, Vec2(minX, minY), Vec2(maxX, maxY)))
+                {
+                    cell = RiverCellEdge;
+                }
+            }
+
+            m_River[(y * m_NumCellsX) + x] = (unsigned char)cell;
+        }
+    }
+}
+
+void CollisionField::buildTowerMasks()
+{
+    std::fill(m_TowerMasks.begin(), m_TowerMasks.end(), (unsigned short)0);
+
+    for (int mobType = 0; mobType < iEntityStats::numMobTypes; ++mobType)
+    {
+        const float halfSize = getStatRow(getStatIndex((iEntityStats::MobType)mobType)).m_HalfSize;
+        for (unsigned int i = 0; i < m_Towers.size(); ++i)
+        {
+            const Tower& tower = m_Towers[i];
+            const float reach = tower.m_HalfSize + halfSize + ksTowerSlop;
+
+            // Only visit the cells that the tower (padded by the mob) reaches.
+            const int minX = std::max(0, (int)((tower.m_Pos.x - reach) * ksInvCellSize) - 1);
+            const int maxX = std::min(m_NumCellsX - 1, (int)((tower.m_Pos.x + reach) * ksInvCellSize) + 1);
+            const int minY = std::max(0, (int)((tower.m_Pos.y - reach) * ksInvCellSize) - 1);
+            const int maxY = std::min(m_NumCellsY - 1, (int)((tower.m_Pos.y + reach) * ksInvCellSize) + 1);
+            for (int y = minY; y <= maxY; ++y)
+            {
+                const float cellMinY = (float)y * ksCellSize;
+                if ((cellMinY + ksCellSize < tower.m_Pos.y - reach) || (cellMinY > tower.m_Pos.y + reach))
+                {
+                    continue;
+                }
+
+                for (int x = minX; x <= maxX; ++x)
+                {
+                    const float cellMinX = (float)x * ksCellSize;
+                    if ((cellMinX + ksCellSize < tower.m_Pos.x - reach) || (cellMinX > tower.m_Pos.x + reach))
+                    {
+                        continue;
+                    }
+
+                    const int cell = (y * m_NumCellsX) + x;
+                    m_TowerMasks[(cell * iEntityStats::numMobTypes) + mobType] |= (unsigned short)(1 << i);
+                }
+            }
+        }
+    }
+}
+
+int CollisionField::getCell(const Vec2& pos) const
+{
+    if ((pos.x < 0.f) || (pos.x > GAME_GRID_WIDTH) || (pos.y < 0.f) || (pos.y > GAME_GRID_HEIGHT))
+    {
+        return -1;
+    }
+
+    // A point on the right or bottom edge of the map goes in the last cell,
+    //  which is fine because the cells were classified edges included.
+    const int x = std::min(m_NumCellsX - 1, (int)(pos.x * ksInvCellSize));
+    const int y = std::min(m_NumCellsY - 1, (int)(pos.y * ksInvCellSize));
+    return (y * m_NumCellsX) + x;
+}
+
+CollisionField::RiverPush CollisionField::getRiverPush(const Vec2& pos) const
+{
+    const int cell = getCell(pos);
+    if (cell < 0)
+    {
+        // The river runs off the right edge of the map.
+        return getExactRiverPush(pos);
+    }
+
+    const RiverCell river = (RiverCell)m_River[cell];
+    return (river == RiverCellEdge) ? getExactRiverPush(pos) : (RiverPush)river;
+}
+
+bool CollisionField::overlapsRiver(const Vec2& minPt, const Vec2& maxPt) const
+{
+    for (const RiverSpan& span : ksRiverSpans)
+    {
+        if (overlapsSpan(span, minPt, maxPt))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool CollisionField::isBlocked(const Vec2& pos, int mobStatIndex) const
+{
+    const int cell = getCell(pos);
+    if (cell < 0)
+    {
+        return true;
+    }
+
+    const RiverCell river = (RiverCell)m_River[cell];
+    if ((river == RiverCellPushRight) || (river == RiverCellPushLeft))
+    {
+        return true;
+    }
+    if ((river == RiverCellEdge) && (getExactRiverPush(pos) != RiverNone))
+    {
+        return true;
+    }
+
+    assert(mobStatIndex < iEntityStats::numMobTypes);
+    unsigned int mask = m_TowerMasks[(cell * iEntityStats::numMobTypes) + mobStatIndex];
+    for (unsigned int i = 0; mask != 0; ++i, mask >>= 1)
+    {
+        if ((mask & 1) && overlapsTower(i, pos, mobStatIndex))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+unsigned int CollisionField::getTowerMask(const Vec2& pos, int mobStatIndex) const
+{
+    assert(mobStatIndex < iEntityStats::numMobTypes);
+    const int cell = getCell(pos);
+
+    // Mobs that have been pushed off the map can still be touching a tower,
+    //  so they have to check them all.
+    return (cell < 0) ? ((1u << m_Towers.size()) - 1) 
+                      : m_TowerMasks[(cell * iEntityStats::numMobTypes) + mobStatIndex];
+}
+
+bool CollisionField::overlapsTower(unsigned int tower, const Vec2& pos, int mobStatIndex) const
+{
+    assert(tower < m_Towers.size());
+    const Tower& t = m_Towers[tower];
+    const float halfSize = getStatRow(mobStatIndex).m_HalfSize;
+
+    return aabbOverlaps(t.m_Pos, t.m_HalfSize, pos, halfSize);
+}
@@ -0,0 +1,103 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStore.h"
+#include "Vec2.h"
+#include <vector>
+
+// The parts of the arena that never move - the map edges, the river (with the
+//  gaps in it for the bridges) and the towers - baked into a grid, so that a 
+//  mob can look up what it's touching instead of testing against all of it.
+//  It's built when the match starts, and rebuilt whenever a tower is 
+//  destroyed (dead towers don't block anything).
+//
+// NOTE: Each cell records whether it's entirely in the river, entirely out 
+//  of it, or straddles an edge, and which towers a mob in that cell *might* 
+//  touch.  Only the straddling cells and the towers that might be touched
+//  fall back to an exact test, so lookups give exactly the same answers as
+//  testing against the geometry in Constants.h directly.
+class CollisionField
+{
+public:
+    // Which way the river pushes a mob whose center is in it.
+    enum RiverPush
+    {
+        RiverNone = 0,
+        RiverPushRight,     // the stretch left of the left bridge
+        RiverPushLeft,      // everything else
+    };
+
+    CollisionField();
+
+    void build(const EntityStore& northBuildings, const EntityStore& southBuildings);
+
+    RiverPush getRiverPush(const Vec2& pos) const;
+
+    // True if any part of the box (edges included) is in the river.
+    bool overlapsRiver(const Vec2& minPt, const Vec2& maxPt) const;
+
+    // True if a mob of the given type can't be at pos: it's off the map, in 
+    //  the river, or overlapping a tower.
+    bool isBlocked(const Vec2& pos, int mobStatIndex) const;
+
+    // Bit i is set if a mob of the given type at pos might overlap tower i 
+    //  (the north player's live towers come first, then the south's).  Use
+    //  overlapsTower() to find out for sure.
+    unsigned int getTowerMask(const Vec2& pos, int mobStatIndex) const;
+    bool overlapsTower(unsigned int tower, const Vec2& pos, int mobStatIndex) const;
+
+    unsigned int getNumTowers() const { return (unsigned int)m_Towers.size(); }
+    const Vec2& getTowerPosition(unsigned int tower) const { return m_Towers[tower].m_Pos; }
+    float getTowerHalfSize(unsigned int tower) const { return m_Towers[tower].m_HalfSize; }
+
+private:
+    enum RiverCell
+    {
+        RiverCellNone = RiverNone,
+        RiverCellPushRight = RiverPushRight,
+        RiverCellPushLeft = RiverPushLeft,
+        RiverCellEdge,
+    };
+
+    struct Tower
+    {
+        Vec2 m_Pos;
+        float m_HalfSize;
+    };
+
+    void addTowers(const EntityStore& buildings);
+    void buildRiver();
+    void buildTowerMasks();
+
+    // Returns -1 if pos is off the map.
+    int getCell(const Vec2& pos) const;
+
+private:
+    int m_NumCellsX;
+    int m_NumCellsY;
+
+    std::vector<Tower> m_Towers;
+    std::vector<unsigned char> m_River;         // a RiverCell per cell
+    std::vector<unsigned short> m_TowerMasks;   // numMobTypes per cell
+};
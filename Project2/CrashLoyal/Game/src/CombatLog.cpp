@@ -0,0 +1,411 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "CombatLog.h"
+
+#include "Entity.h"
+#include "EntityStatTable.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <ostream>
+
+static const char ksMagic[4] = { 'C', 'L', 'O', 'G' };
+
+// How long the writer sleeps when it has emptied the ring.
+static const std::chrono::milliseconds ksWriterSleep(1);
+
+CombatLog::CombatLog()
+    : m_pSlots(NULL)
+    , m_PushPos(0)
+    , m_PopPos(0)
+    , m_bRunning(false)
+    , m_Tick(0)
+    , m_pFile(NULL)
+    , m_Format(Text)
+    , m_pBatch(NULL)
+    , m_bQuit(false)
+    , m_NumWritten(0)
+    , m_NumDropped(0)
+{
+    static_assert((ksCapacity & (ksCapacity - 1)) == 0, "ksCapacity must be a power of 2");
+}
+
+CombatLog::~CombatLog()
+{
+    stop();
+    delete[] m_pSlots;
+    delete[] m_pBatch;
+}
+
+bool CombatLog::start(const char* pPath, Format format)
+{
+    stop();
+
+    if (strcmp(pPath, "-") == 0)
+    {
+        m_pFile = stdout;
+    }
+    else
+    {
+        m_pFile = fopen(pPath, (format == Binary) ? "wb" : "w");
+        if (!m_pFile)
+            return false;
+    }
+
+    // Most games never log anything, so the ring isn't made until it's needed.
+    //  It's empty whenever the log isn't running, so it can be reused as is.
+    if (!m_pSlots)
+    {
+        m_pSlots = new Slot[ksCapacity];
+        m_pBatch = new CombatEvent[ksBatchSize];
+        for (unsigned int i = 0; i < ksCapacity; ++i)
+        {
+            m_pSlots[i].m_Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    m_Format = format;
+    m_NumWritten = 0;
+    m_NumDropped = 0;
+
+    if (m_Format == Binary)
+    {
+        FileHeader header;
+        memcpy(header.m_Magic, ksMagic, sizeof(ksMagic));
+        header.m_Version = ksVersion;
+        header.m_EventSize = sizeof(CombatEvent);
+        header.m_Reserved = 0;
+        fwrite(&header, sizeof(header), 1, m_pFile);
+    }
+
+    m_bQuit = false;
+    m_Writer = std::thread(&CombatLog::writerMain, this);
+    m_bRunning = true;
+    return true;
+}
+
+void CombatLog::stop()
+{
+    if (!m_bRunning)
+        return;
+
+    // The writer empties the ring before it quits.
+    m_bRunning = false;
+    m_bQuit = true;
+    m_Writer.join();
+
+    if ((m_Format == Text) && (m_NumDropped > 0))
+    {
+        fprintf(m_pFile, "%llu events were dropped because the log couldn't keep up.\n", (unsigned long long)m_NumDropped);
+    }
+
+    if (m_pFile == stdout)
+        fflush(m_pFile);
+    else
+        fclose(m_pFile);
+    m_pFile = NULL;
+}
+
+CombatEvent CombatLog::makeEvent(CombatEvent::Type type, const Entity& entity)
+{
+    CombatEvent event = {};
+    event.m_Type = (unsigned char)type;
+    event.m_bNorth = entity.isNorth();
+    event.m_StatIndex = (unsigned char)entity.getStatIndex();
+    event.m_Entity = entity.getHandle();
+    return event;
+}
+
+void CombatLog::logAttack(const Entity& attacker, const Entity& target, int damage)
+{
+    if (!m_bRunning)
+        return;
+
+    CombatEvent event = makeEvent(CombatEvent::Attack, attacker);
+    event.m_bOtherNorth = target.isNorth();
+    event.m_OtherStatIndex = (unsigned char)target.getStatIndex();
+    event.m_Other = target.getHandle();
+    event.m_Value = damage;
+    push(event);
+}
+
+void CombatLog::logDamage(const Entity& target, const Entity& attacker)
+{
+    if (!m_bRunning)
+        return;
+
+    CombatEvent event = makeEvent(CombatEvent::Damage, target);
+    event.m_bOtherNorth = attacker.isNorth();
+    event.m_OtherStatIndex = (unsigned char)attacker.getStatIndex();
+    event.m_Other = attacker.getHandle();
+    event.m_Value = target.getHealth();
+    push(event);
+}
+
+void CombatLog::logDeath(const Entity& target, const Entity& attacker)
+{
+    if (!m_bRunning)
+        return;
+
+    CombatEvent event = makeEvent(CombatEvent::Death, target);
+    event.m_bOtherNorth = attacker.isNorth();
+    event.m_OtherStatIndex = (unsigned char)attacker.getStatIndex();
+    event.m_Other = attacker.getHandle();
+    push(event);
+}
+
+void CombatLog::logSpawn(const Entity& mob)
+{
+    if (!m_bRunning)
+        return;
+
+    CombatEvent event = makeEvent(CombatEvent::Spawn, mob);
+    event.m_Value = mob.getHealth();
+    event.m_X = mob.getPosition().x;
+    event.m_Y = mob.getPosition().y;
+    push(event);
+}
+
+void CombatLog::logPlacementFailed(bool bNorth, iEntityStats::MobType type, const Vec2& pos,
+                                   iPlayer::PlacementResult result, float elixir)
+{
+    if (!m_bRunning)
+        return;
+
+    CombatEvent event = {};
+    event.m_Type = CombatEvent::PlacementFailed;
+    event.m_bNorth = bNorth;
+    event.m_StatIndex = (unsigned char)getStatIndex(type);
+    event.m_Result = (unsigned char)result;
+    event.m_Elixir = elixir;
+    event.m_Entity = EntityHandle();
+    event.m_Other = EntityHandle();
+    event.m_X = pos.x;
+    event.m_Y = pos.y;
+    push(event);
+}
+
+void CombatLog::push(const CombatEvent& event)
+{
+    // NOTE: This is a bounded multi-producer queue: each slot's sequence 
+    //  number says which push it's waiting for, so a producer claims a slot 
+    //  by bumping m_PushPos, and publishes it by bumping the sequence.  If the
+    //  slot still holds an event the writer hasn't taken, the ring is full.
+    unsigned int pos = m_PushPos.load(std::memory_order_relaxed);
+    Slot* pSlot;
+    for (;;)
+    {
+        pSlot = &m_pSlots[pos & (ksCapacity - 1)];
+        const unsigned int sequence = pSlot->m_Sequence.load(std::memory_order_acquire);
+        const int diff = (int)(sequence - pos);
+        if (diff == 0)
+        {
+            if (m_PushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            m_NumDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            pos = m_PushPos.load(std::memory_order_relaxed);
+        }
+    }
+
+    pSlot->m_Event = event;
+    pSlot->m_Event.m_Tick = m_Tick;
+    pSlot->m_Sequence.store(pos + 1, std::memory_order_release);
+}
+
+unsigned int CombatLog::popBatch(CombatEvent* pEvents, unsigned int maxEvents)
+{
+    unsigned int numEvents = 0;
+    while (numEvents < maxEvents)
+    {
+        Slot& slot = m_pSlots[m_PopPos & (ksCapacity - 1)];
+        if (slot.m_Sequence.load(std::memory_order_acquire) != m_PopPos + 1)
+            break;
+
+        pEvents[numEvents++] = slot.m_Event;
+        slot.m_Sequence.store(m_PopPos + ksCapacity, std::memory_order_release);
+        ++m_PopPos;
+    }
+    return numEvents;
+}
+
+void CombatLog::writerMain()
+{
+    for (;;)
+    {
+        // Read the flag first, so that everything pushed before stop() was 
+        //  called is in the ring by the time we see it.
+        const bool bQuit = m_bQuit;
+
+        const unsigned int numEvents = popBatch(m_pBatch, ksBatchSize);
+        if (numEvents > 0)
+        {
+            writeBatch(m_pBatch, numEvents);
+            continue;
+        }
+
+        if (bQuit)
+            break;
+
+        fflush(m_pFile);
+        std::this_thread::sleep_for(ksWriterSleep);
+    }
+}
+
+void CombatLog::writeBatch(const CombatEvent* pEvents, unsigned int numEvents)
+{
+    if (m_Format == Binary)
+    {
+        fwrite(pEvents, sizeof(CombatEvent), numEvents, m_pFile);
+    }
+    else
+    {
+        char line[256];
+        for (unsigned int i = 0; i < numEvents; ++i)
+        {
+            const int length = formatEvent(pEvents[i], line, sizeof(line));
+            fwrite(line, 1, (size_t)length, m_pFile);
+        }
+    }
+    m_NumWritten += numEvents;
+}
+
+static const char* getSideName(unsigned char bNorth)
+{
+    return bNorth ? "North" : "South";
+}
+
+static const char* getStatName(unsigned char statIndex)
+{
+    return (statIndex < NUM_STAT_TYPES) ? ENTITY_STATS[statIndex].m_Name : "???";
+}
+
+int CombatLog::formatEvent(const CombatEvent& event, char* pBuffer, unsigned int bufferSize)
+{
+    assert(bufferSize > 0);
+
+    const char* pSide = getSideName(event.m_bNorth);
+    const char* pName = getStatName(event.m_StatIndex);
+    const char* pOtherSide = getSideName(event.m_bOtherNorth);
+    const char* pOtherName = getStatName(event.m_OtherStatIndex);
+
+    int length = 0;
+    switch (event.m_Type)
+    {
+    case CombatEvent::Attack:
+        length = snprintf(pBuffer, bufferSize, "%6u: %s %s attacks %s %s for %d damage.\n",
+                          event.m_Tick, pSide, pName, pOtherSide, pOtherName, event.m_Value);
+        break;
+    case CombatEvent::Damage:
+        length = snprintf(pBuffer, bufferSize, "%6u: %s %s has %d health left.\n",
+                          event.m_Tick, pSide, pName, event.m_Value);
+        break;
+    case CombatEvent::Death:
+        length = snprintf(pBuffer, bufferSize, "%6u: %s %s was killed by %s %s.\n",
+                          event.m_Tick, pSide, pName, pOtherSide, pOtherName);
+        break;
+    case CombatEvent::Spawn:
+        length = snprintf(pBuffer, bufferSize, "%6u: %s %s placed at (%g, %g).\n",
+                          event.m_Tick, pSide, pName, event.m_X, event.m_Y);
+        break;
+    case CombatEvent::PlacementFailed:
+        switch (event.m_Result)
+        {
+        case iPlayer::InvalidX:
+            length = snprintf(pBuffer, bufferSize, "%6u: %s Invalid Location (X): (%g, %g)\n",
+                              event.m_Tick, pSide, event.m_X, event.m_Y);
+            break;
+        case iPlayer::InvalidY:
+            length = snprintf(pBuffer, bufferSize, "%6u: %s Invalid Location (Y): (%g, %g)\n",
+                              event.m_Tick, pSide, event.m_X, event.m_Y);
+            break;
+        case iPlayer::InsufficientElixir:
+            length = snprintf(pBuffer, bufferSize, "%6u: %s Insufficient Elixir: %g > %g\n", event.m_Tick, pSide,
+                              (event.m_StatIndex < NUM_STAT_TYPES) ? ENTITY_STATS[event.m_StatIndex].m_ElixirCost : 0.f,
+                              event.m_Elixir);
+            break;
+        case iPlayer::MobTypeUnavailable:
+            length = snprintf(pBuffer, bufferSize, "%6u: %s Mob type not available (%s)\n",
+                              event.m_Tick, pSide, pName);
+            break;
+        default:
+            length = snprintf(pBuffer, bufferSize, "%6u: %s %s couldn't be placed (%u)\n",
+                              event.m_Tick, pSide, pName, (unsigned int)event.m_Result);
+            break;
+        }
+        break;
+    default:
+        length = snprintf(pBuffer, bufferSize, "%6u: Unknown event (%u)\n", event.m_Tick, (unsigned int)event.m_Type);
+        break;
+    }
+
+    // snprintf() returns how long the line would have been.
+    if (length < 0)
+        length = 0;
+    else if ((unsigned int)length >= bufferSize)
+        length = (int)bufferSize - 1;
+    return length;
+}
+
+bool CombatLog::printBinaryLog(const char* pPath, std::ostream& out)
+{
+    FILE* pFile = fopen(pPath, "rb");
+    if (!pFile)
+    {
+        out << "Couldn't open " << pPath << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    if ((fread(&header, sizeof(header), 1, pFile) != 1) ||
+        (memcmp(header.m_Magic, ksMagic, sizeof(ksMagic)) != 0) ||
+        (header.m_Version != ksVersion) ||
+        (header.m_EventSize != sizeof(CombatEvent)))
+    {
+        out << pPath << " isn't a combat log that this version can read" << std::endl;
+        fclose(pFile);
+        return false;
+    }
+
+    CombatEvent events[ksBatchSize];
+    char line[256];
+    size_t numEvents;
+    while ((numEvents = fread(events, sizeof(CombatEvent), ksBatchSize, pFile)) > 0)
+    {
+        for (size_t i = 0; i < numEvents; ++i)
+        {
+            const int length = formatEvent(events[i], line, sizeof(line));
+            out.write(line, length);
+        }
+    }
+
+    fclose(pFile);
+    return true;
+}
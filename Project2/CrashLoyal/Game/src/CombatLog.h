@@ -0,0 +1,179 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "EntityStats.h"
+#include "iPlayer.h"
+#include "Vec2.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iosfwd>
+#include <thread>
+
+class Entity;
+
+// One thing that happened during a match.  These are written to the log as
+// they are, so the layout is part of the binary log format - bump 
+// CombatLog::ksVersion if you change it.
+struct CombatEvent
+{
+    enum Type
+    {
+        Attack,             // m_Entity hit m_Other for m_Value damage
+        Damage,             // m_Entity was hit by m_Other, and has m_Value health left
+        Death,              // m_Entity was killed by m_Other
+        Spawn,              // m_Entity was placed
+        PlacementFailed,    // a placeMob() call for m_StatIndex failed with m_Result
+
+        NumTypes
+    };
+
+    unsigned int m_Tick;
+    unsigned char m_Type;
+    unsigned char m_bNorth;
+    unsigned char m_StatIndex;          // into ENTITY_STATS
+    unsigned char m_bOtherNorth;
+    unsigned char m_OtherStatIndex;
+    unsigned char m_Result;             // iPlayer::PlacementResult
+    unsigned char m_Pad[2];
+    int m_Value;
+    float m_Elixir;                     // the player's, for PlacementFailed
+    EntityHandle m_Entity;
+    EntityHandle m_Other;
+    // Where m_Entity was placed (or was to be), for Spawn and PlacementFailed.
+    //  Damage is dealt while the mobs are moving, so the others don't know.
+    float m_X;
+    float m_Y;
+};
+static_assert(sizeof(CombatEvent) == 44, "CombatEvent is part of the log format");
+
+// Attacks, deaths, spawns and failed placements are pushed into a fixed size
+// ring buffer as they happen, and a background thread takes them out and 
+// writes them to a file - either as they are (see printBinaryLog()), or 
+// printed out as text.  Pushing an event is a copy and an atomic increment, 
+// so it's safe to do from any thread in the middle of a tick, and nothing on
+// the tick's side ever formats text or waits for I/O.
+//
+// NOTE: If the writer falls so far behind that the ring fills up, new events
+// are dropped (and counted) rather than making the tick wait.  Events from 
+// phases that run at the same time (the two controllers, say) may be 
+// interleaved.
+class CombatLog
+{
+public:
+    enum Format
+    {
+        Binary,
+        Text,
+    };
+
+    static const unsigned int ksVersion = 1;
+
+    CombatLog();
+    ~CombatLog();
+
+    // Starts writing to pPath ("-" means stdout).  Returns false if the file
+    //  couldn't be opened.  Any log that was already running is stopped first.
+    bool start(const char* pPath, Format format);
+
+    // Writes out anything that's still in the ring, and closes the file.
+    void stop();
+
+    bool isRunning() const { return m_bRunning; }
+
+    // Stamped on everything that's pushed from now on.
+    void setTick(unsigned int tick) { m_Tick = tick; }
+
+    // These do nothing if the log isn't running.
+    void logAttack(const Entity& attacker, const Entity& target, int damage);
+    void logDamage(const Entity& target, const Entity& attacker);
+    void logDeath(const Entity& target, const Entity& attacker);
+    void logSpawn(const Entity& mob);
+    void logPlacementFailed(bool bNorth, iEntityStats::MobType type, const Vec2& pos,
+                            iPlayer::PlacementResult result, float elixir);
+
+    // Counts for the log that's running (or that ran last).
+    unsigned long long getNumWritten() const { return m_NumWritten; }
+    unsigned long long getNumDropped() const { return m_NumDropped; }
+
+    // Prints out a log that was written in the Binary format.  Returns false
+    //  if it couldn't be read.
+    static bool printBinaryLog(const char* pPath, std::ostream& out);
+
+    // Returns the length of the line (which is cut short if it doesn't fit).
+    static int formatEvent(const CombatEvent& event, char* pBuffer, unsigned int bufferSize);
+
+private:
+    struct Slot
+    {
+        // The slot is free for the push numbered m_Sequence, or (if this is
+        //  one more than that) holds that push's event.
+        std::atomic<unsigned int> m_Sequence;
+        CombatEvent m_Event;
+    };
+
+    // Big enough for a few seconds of the biggest fights at full speed.
+    static const unsigned int ksCapacity = 1 << 16;
+    static const unsigned int ksBatchSize = 256;
+
+    struct FileHeader
+    {
+        char m_Magic[4];
+        unsigned int m_Version;
+        unsigned int m_EventSize;
+        unsigned int m_Reserved;
+    };
+
+    static CombatEvent makeEvent(CombatEvent::Type type, const Entity& entity);
+    void push(const CombatEvent& event);
+
+    // Only the writer thread pops.  Returns how many events it got.
+    unsigned int popBatch(CombatEvent* pEvents, unsigned int maxEvents);
+
+    void writerMain();
+    void writeBatch(const CombatEvent* pEvents, unsigned int numEvents);
+
+private:
+    Slot* m_pSlots;
+    std::atomic<unsigned int> m_PushPos;
+    unsigned int m_PopPos;
+
+    bool m_bRunning;
+    unsigned int m_Tick;
+
+    FILE* m_pFile;
+    Format m_Format;
+    CombatEvent* m_pBatch;          // the writer's
+    std::thread m_Writer;
+    std::atomic<bool> m_bQuit;
+
+    std::atomic<unsigned long long> m_NumWritten;
+    std::atomic<unsigned long long> m_NumDropped;
+
+private:
+    // DELIBERATELY UNDEFINED
+    CombatLog(const CombatLog& rhs);
+    CombatLog& operator=(const CombatLog& rhs);
+};
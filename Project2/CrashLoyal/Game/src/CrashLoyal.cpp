@@ -20,15 +20,33 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include "Benchmark.h"
 #include "Building.h"
 #include "Constants.h"
-#include "Controller_UI.h"
+#include "Controller_AI_KevinDill.h"
 #include "Game.h"
-#include "Graphics.h"
+#include "Headless.h"
 #include "Player.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "Scenario.h"
+#include "ScenarioGenerator.h"
+#include "Tournament.h"
 
+#ifndef CRASHLOYAL_HEADLESS
+#include "Controller_UI.h"
+#include "Graphics.h"
+#endif
+
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
 
+#ifndef CRASHLOYAL_HEADLESS
 bool init() {
     return true;
 }
@@ -40,10 +58,295 @@ void close() {
     IMG_Quit();
     SDL_Quit();
 }
+#endif
+
+// Starts the game from a scenario file, and says how long it took.
+static bool loadScenario(Game& game, const char* pPath) {
+    using namespace std::chrono;
+
+    const high_resolution_clock::time_point startTime = high_resolution_clock::now();
+    Scenario scenario;
+    if (!scenario.open(pPath)) {
+        std::cout << "Couldn't load the scenario " << pPath << std::endl;
+        return false;
+    }
+    game.loadScenario(scenario);
+    const double ms = duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - startTime).count();
+
+    std::cout << "Loaded " << pPath << ": " << scenario.getNumMobs(true) << " North mobs, "
+        << scenario.getNumMobs(false) << " South mobs in " << ms << " ms" << std::endl;
+    return true;
+}
+
+// Writes out what the profiler recorded, if it was asked for.
+static void finishProfile(const char* pTracePath) {
+    if (!pTracePath) {
+        return;
+    }
+
+    Profiler::stop();
+    Profiler::writeReport(std::cout);
+    if (!Profiler::writeChromeTrace(pTracePath)) {
+        std::cout << "Couldn't write the trace " << pTracePath << std::endl;
+    }
+}
 
 int main(int argc, char* args[]) {
-    Game& game = Game::get();
+    // Command line:
+    //   -headless      run without a window (always on in the headless build)
+    //   -ticks <n>     maximum number of ticks for a headless match
+    //   -hz <n>        simulation ticks per second of game time
+    //   -bruteforce    check every mob against every other mob, rather than
+    //                  using the mob grid (for A/B comparisons)
+    //   -threads <n>   how many threads to tick the game on (the default, 0,
+    //                  means one per hardware thread)
+    //   -phases        report how long each phase of the tick took, and which
+    //                  ones were on the critical path (headless only)
+    //   -benchoverlap  time the AABB overlap kernels, then quit
+    //   -benchsnapshot time saving and restoring the game, then quit
+    //   -benchsim <file> time the simulation on synthetic battles, write the
+    //                  results to a file ("-" is the console), then quit.  
+    //                  Goes up to -benchmobs mobs (100000 by default) on 
+    //                  -threads threads.
+    //   -log <file>    write the combat log to a file, in the binary format
+    //   -logtext <file> write the combat log to a file as text ("-" is the 
+    //                  console, which is the default)
+    //   -nolog         don't write a combat log at all
+    //   -printlog <file> print out a binary combat log, then quit
+    //   -record <file> save a replay of the match (headless only)
+    //   -replay <file> play a replay back as fast as possible, and check that
+    //                  it ends the same way (no combat log unless asked for)
+    //   -tournament <file> play every AI against every other one, and write 
+    //                  the results to a file ("-" is the console).  -threads 
+    //                  is how many matches to play at once, and -ticks is how 
+    //                  long a match can go.
+    //   -matches <n>   how many matches each side of a tournament pairing plays
+    //   -scenario <file> start the match from a scenario file.  A replay of 
+    //                  it has to be played back from the same scenario.
+    //   -genscenario <kind> <n> <file> write a stress scenario with n mobs 
+    //                  to a file, then quit (see generateScenario() for the 
+    //                  kinds)
+    //   -seed <n>      the random seed for -genscenario
+    //   -profile <file> time the tick phases, the collision checks and the 
+    //                  drawing, and write a Chrome trace of them to a file.
+    //                  A summary is printed at the end.  Only works if 
+    //                  CRASHLOYAL_PROFILE was defined.
+    bool bHeadless = false;
+    bool bBruteForce = false;
+    unsigned int numThreads = 0;
+    float simHz = SIM_HZ;
+    const char* pLogPath = NULL;
+    bool bNoLog = false;
+    CombatLog::Format logFormat = CombatLog::Text;
+    const char* pReplayPath = NULL;
+    HeadlessConfig headlessConfig;
+    TournamentConfig tournamentConfig;
+    const char* pTournamentPath = NULL;
+    const char* pBenchSimPath = NULL;
+    unsigned int benchMobs = 100000;
+    const char* pScenarioPath = NULL;
+    const char* pGenKind = NULL;
+    unsigned int genMobs = 0;
+    const char* pGenPath = NULL;
+    unsigned int genSeed = 1;
+    const char* pProfilePath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(args[i], "-headless") == 0) {
+            bHeadless = true;
+        }
+        else if ((strcmp(args[i], "-ticks") == 0) && (i + 1 < argc)) {
+            headlessConfig.m_MaxTicks = (unsigned int)atoi(args[++i]);
+            tournamentConfig.m_MaxTicks = headlessConfig.m_MaxTicks;
+        }
+        else if ((strcmp(args[i], "-hz") == 0) && (i + 1 < argc)) {
+            simHz = std::max(1.f, (float)atof(args[++i]));
+        }
+        else if (strcmp(args[i], "-bruteforce") == 0) {
+            bBruteForce = true;
+        }
+        else if ((strcmp(args[i], "-threads") == 0) && (i + 1 < argc)) {
+            numThreads = (unsigned int)std::max(0, atoi(args[++i]));
+            tournamentConfig.m_NumThreads = numThreads;
+        }
+        else if (strcmp(args[i], "-phases") == 0) {
+            headlessConfig.m_bReportPhases = true;
+        }
+        else if (strcmp(args[i], "-benchoverlap") == 0) {
+            return runOverlapBenchmark(std::cout) ? 0 : 1;
+        }
+        else if (strcmp(args[i], "-benchsnapshot") == 0) {
+            return runSnapshotBenchmark(std::cout) ? 0 : 1;
+        }
+        else if ((strcmp(args[i], "-log") == 0) && (i + 1 < argc)) {
+            pLogPath = args[++i];
+            logFormat = CombatLog::Binary;
+        }
+        else if ((strcmp(args[i], "-logtext") == 0) && (i + 1 < argc)) {
+            pLogPath = args[++i];
+            logFormat = CombatLog::Text;
+        }
+        else if (strcmp(args[i], "-nolog") == 0) {
+            bNoLog = true;
+        }
+        else if ((strcmp(args[i], "-printlog") == 0) && (i + 1 < argc)) {
+            return CombatLog::printBinaryLog(args[++i], std::cout) ? 0 : 1;
+        }
+        else if ((strcmp(args[i], "-record") == 0) && (i + 1 < argc)) {
+            headlessConfig.m_pRecordPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-replay") == 0) && (i + 1 < argc)) {
+            pReplayPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-tournament") == 0) && (i + 1 < argc)) {
+            pTournamentPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-benchsim") == 0) && (i + 1 < argc)) {
+            pBenchSimPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-benchmobs") == 0) && (i + 1 < argc)) {
+            benchMobs = (unsigned int)std::max(1, atoi(args[++i]));
+        }
+        else if ((strcmp(args[i], "-scenario") == 0) && (i + 1 < argc)) {
+            pScenarioPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-genscenario") == 0) && (i + 3 < argc)) {
+            pGenKind = args[++i];
+            genMobs = (unsigned int)std::max(0, atoi(args[++i]));
+            pGenPath = args[++i];
+        }
+        else if ((strcmp(args[i], "-profile") == 0) && (i + 1 < argc)) {
+            pProfilePath = args[++i];
+        }
+        else if ((strcmp(args[i], "-seed") == 0) && (i + 1 < argc)) {
+            genSeed = (unsigned int)atoi(args[++i]);
+        }
+        else if ((strcmp(args[i], "-matches") == 0) && (i + 1 < argc)) {
+            tournamentConfig.m_MatchesPerSide = (unsigned int)std::max(1, atoi(args[++i]));
+        }
+    }
+    headlessConfig.m_DeltaTSec = 1.f / simHz;
+    tournamentConfig.m_DeltaTSec = 1.f / simHz;
+
+    if (pGenPath) {
+        ScenarioLayout layout;
+        if (!generateScenario(pGenKind, genMobs, genSeed, layout)) {
+            std::cout << "Unknown scenario kind " << pGenKind << " (try bridge, blob or siege)" << std::endl;
+            return 1;
+        }
+        if (!layout.save(pGenPath)) {
+            std::cout << "Couldn't write the scenario " << pGenPath << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (pBenchSimPath) {
+        if (strcmp(pBenchSimPath, "-") == 0) {
+            runSimBenchmark(std::cout, benchMobs, numThreads);
+            return 0;
+        }
+
+        std::ofstream results(pBenchSimPath);
+        if (!results) {
+            std::cout << "Couldn't open " << pBenchSimPath << std::endl;
+            return 1;
+        }
+        runSimBenchmark(results, benchMobs, numThreads);
+        return 0;
+    }
+
+    if (pTournamentPath) {
+        unsigned int numEntrants;
+        const TournamentEntrant* pEntrants = getTournamentEntrants(numEntrants);
+        if (strcmp(pTournamentPath, "-") == 0) {
+            runTournament(pEntrants, numEntrants, tournamentConfig, std::cout, std::cout);
+            return 0;
+        }
+
+        std::ofstream results(pTournamentPath);
+        if (!results) {
+            std::cout << "Couldn't open " << pTournamentPath << std::endl;
+            return 1;
+        }
+        runTournament(pEntrants, numEntrants, tournamentConfig, results, std::cout);
+        return 0;
+    }
+
+    if (pProfilePath) {
+        if (Profiler::isCompiledIn()) {
+            Profiler::start();
+        }
+        else {
+            std::cout << "The profiler isn't compiled in (define CRASHLOYAL_PROFILE)" << std::endl;
+            pProfilePath = NULL;
+        }
+    }
+
+    if (bNoLog) {
+        pLogPath = NULL;
+    }
+    else if (!pLogPath && !pReplayPath) {
+        pLogPath = "-";
+    }
+
+    if (pReplayPath) {
+        Replay replay;
+        if (!replay.load(pReplayPath)) {
+            std::cout << "Couldn't load the replay " << pReplayPath << std::endl;
+            return 1;
+        }
+
+        Game* pGame = new Game(new ReplayController(replay, true), new ReplayController(replay, false), numThreads);
+        pGame->setUseMobGrid(!bBruteForce);
+        if (pScenarioPath && !loadScenario(*pGame, pScenarioPath)) {
+            delete pGame;
+            return 1;
+        }
+        if (pLogPath && !pGame->getCombatLog().start(pLogPath, logFormat)) {
+            std::cout << "Couldn't open the combat log " << pLogPath << std::endl;
+        }
+        const bool bMatched = runReplay(*pGame, replay);
+        delete pGame;
+        finishProfile(pProfilePath);
+        return bMatched ? 0 : 1;
+    }
+
+#ifdef CRASHLOYAL_HEADLESS
+    bHeadless = true;
+#endif
+
+    if (bHeadless) {
+        // Nobody is there to click on anything, so the AI plays both sides.
+        Game* pGame = new Game(new Controller_AI_KevinDill, new Controller_AI_KevinDill, numThreads);
+        pGame->setUseMobGrid(!bBruteForce);
+        if (pScenarioPath && !loadScenario(*pGame, pScenarioPath)) {
+            delete pGame;
+            return 1;
+        }
+        if (pLogPath && !pGame->getCombatLog().start(pLogPath, logFormat)) {
+            std::cout << "Couldn't open the combat log " << pLogPath << std::endl;
+        }
+        runHeadless(*pGame, headlessConfig);
+        delete pGame;
+        finishProfile(pProfilePath);
+        return 0;
+    }
+
+#ifndef CRASHLOYAL_HEADLESS
+    Game* pGame = new Game();
+    Game& game = *pGame;
+    game.setUseMobGrid(!bBruteForce);
+    game.setNumThreads(numThreads);
+    if (pScenarioPath && !loadScenario(game, pScenarioPath)) {
+        delete pGame;
+        return 1;
+    }
+    if (pLogPath && !game.getCombatLog().start(pLogPath, logFormat)) {
+        std::cout << "Couldn't open the combat log " << pLogPath << std::endl;
+    }
+
     Graphics& graphics = Graphics::get();
+    game.getEvents().subscribe(graphics);
 
     //Start up SDL and create window
     if (!init()) {
@@ -51,29 +354,35 @@ int main(int argc, char* args[]) {
     }
     else {
         using namespace std::chrono;
+
+        // The game is always ticked in fixed steps of stepSec, no matter how
+        // fast we're rendering.  Real time is banked in the accumulator, and 
+        // we take as many steps as it pays for (so we catch up after a stall),
+        // then sleep until the next step is due.
+        const double stepSec = 1.0 / simHz;
+        double accumulatorSec = 0.0;
         high_resolution_clock::time_point prevTime = high_resolution_clock::now();
 
+        // For the UI panel
+        high_resolution_clock::time_point prevFrameTime = prevTime;
+        double renderMs = 0.0;
+
         bool quit = false;
         SDL_Event e;
         while (!quit) {
-            // Get the elapsed time, and ensure it's at between TICK_MIN and TICK_MAX
             high_resolution_clock::time_point now = high_resolution_clock::now();
-            double deltaTSec = (float)duration_cast<milliseconds>(now - prevTime).count() / 1000;
+            double frameSec = duration_cast<duration<double>>(now - prevTime).count();
+            prevTime = now;
 
-            if (deltaTSec > TICK_MAX)
+            // Don't try to catch up on more than TICK_MAX of game time at once,
+            //  or a long stall (e.g. dragging the window) would freeze us 
+            //  while we grind through all of the missed steps.
+            if (frameSec > TICK_MAX)
             {
-                std::cout << "Tick duration over budget: " << deltaTSec << std::endl;
-                deltaTSec = TICK_MAX;
+                std::cout << "Tick duration over budget: " << frameSec << std::endl;
+                frameSec = TICK_MAX;
             }
-
-            if (deltaTSec < TICK_MIN)
-                continue;
-
-            prevTime = now;
-
-            graphics.resetFrame();
-
-            // TICK 
+            accumulatorSec += frameSec;
 
             while (SDL_PollEvent(&e) != 0) {
                 if (e.type == SDL_QUIT) { quit = true; }
@@ -82,46 +391,95 @@ int main(int argc, char* args[]) {
                 }
             }
 
-            if (Controller_UI::exists()) {
-                Controller_UI::get().tick((float)deltaTSec);
+            // TICK 
+            bool bTicked = false;
+            unsigned int numTicks = 0;
+            const unsigned long long startAllocs = getNumHeapAllocs();
+            const high_resolution_clock::time_point simStart = high_resolution_clock::now();
+            while (accumulatorSec >= stepSec) {
+                PROFILE_SCOPE("Sim");
+                if (Controller_UI::exists()) {
+                    Controller_UI::get().tick((float)stepSec);
+                }
+
+                game.tick((float)stepSec);
+
+                accumulatorSec -= stepSec;
+                bTicked = true;
+                ++numTicks;
+            }
+
+            // Nothing has changed since the last frame, so there's nothing to
+            //  draw.  Give the CPU back until the next step is due.
+            if (!bTicked) {
+                std::this_thread::sleep_for(duration<double>(stepSec - accumulatorSec));
+                continue;
             }
 
+            PROFILE_SCOPE("Frame");
+            const high_resolution_clock::time_point frameTime = high_resolution_clock::now();
 
-            game.tick((float)deltaTSec);
+            FrameStats frameStats;
+            frameStats.m_FrameMs = (float)duration_cast<duration<double, std::milli>>(frameTime - prevFrameTime).count();
+            frameStats.m_SimMs = (float)duration_cast<duration<double, std::milli>>(frameTime - simStart).count();
+            frameStats.m_RenderMs = (float)renderMs;
+            frameStats.m_BudgetMs = (float)(stepSec * 1000.0);
+            frameStats.m_NumTicks = numTicks;
+            frameStats.m_NumMobs[0] = game.getPlayer(true).getNumMobs();
+            frameStats.m_NumMobs[1] = game.getPlayer(false).getNumMobs();
+            frameStats.m_NumCollisionPairs = game.getTickCounters().get(NarrowphaseHits);
+            frameStats.m_NumTargetScans = game.getTickCounters().get(TargetScans);
+            frameStats.m_NumHeapAllocs = (unsigned int)((getNumHeapAllocs() - startAllocs) / numTicks);
+            graphics.setFrameStats(frameStats);
+            prevFrameTime = frameTime;
+
+            graphics.resetFrame();
 
             // RENDER
             Player& northPlayer = game.getPlayer(true);
             Player& southPlayer = game.getPlayer(false);
 
-            for (Entity* pBuilding : northPlayer.getBuildings()) {
-                graphics.drawBuilding(pBuilding);
-            }
-
-            for (Entity* pBuilding : southPlayer.getBuildings()) {
-                graphics.drawBuilding(pBuilding);
-            }
-
-            for (Entity* m : northPlayer.getMobs()) {
-                if (!m->isDead()) {
-                    graphics.drawMob(m);
+            {
+                PROFILE_SCOPE("drawBuildings");
+                for (Player* pPlayer : { &northPlayer, &southPlayer }) {
+                    EntityStore& buildings = pPlayer->getBuildings();
+                    for (unsigned int i = 0; i < buildings.size(); ++i) {
+                        graphics.drawBuilding(Entity(buildings, i));
+                    }
                 }
+
+                // The mobs go on top.
+                graphics.flushBatches();
             }
 
-            for (Entity* m : southPlayer.getMobs()) {
-                if (!m->isDead()) {
-                    graphics.drawMob(m);
+            {
+                PROFILE_SCOPE("drawMobs");
+                for (Player* pPlayer : { &northPlayer, &southPlayer }) {
+                    EntityStore& mobs = pPlayer->getMobs();
+                    for (unsigned int i = 0; i < mobs.size(); ++i) {
+                        if (!mobs.isDead(i)) {
+                            graphics.drawMob(Entity(mobs, i));
+                        }
+                    }
                 }
+                graphics.flushBatches();
             }
 
             // If there is a winner, draw the message to the screen
-            graphics.drawWinScreen(game.checkGameOver());
+            graphics.drawWinScreen();
 
+            // NOTE: Presenting waits for vsync, so it isn't counted.
+            renderMs = duration_cast<duration<double, std::milli>>(high_resolution_clock::now() - frameTime).count();
             graphics.render();
         }
 
     }
 
+    delete pGame;
+    finishProfile(pProfilePath);
     close();
+#endif
+
     return 0;
 }
 
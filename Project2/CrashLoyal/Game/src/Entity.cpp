@@ -27,103 +27,224 @@
 #include "Mob.h"
 #include "Player.h"
 
-Entity::Entity(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-    : m_Stats(stats)
-    , m_bNorth(isNorth)
-    , m_Health(stats.getMaxHealth())
-    , m_Pos(pos)
-    , m_pTarget(NULL)
-    , m_bTargetLock(NULL)
-    , m_TimeSinceAttack(0.f)
-    , m_Velocity(Vec2(0, 0))
+Entity::Entity(EntityStore& store, unsigned int index)
+    : Entity(store, index, store.m_Pos[index])
 {
 }
 
-void Entity::tick(float deltaTSec)
+Entity::Entity(EntityStore& store, unsigned int index, Vec2& pos)
+    : m_Pos(pos)
+    , m_Store(store)
+    , m_Index(index)
+    , m_StatRow(store.getStatRow(index))
+    , m_Health(store.m_Health[index])
+    , m_Velocity(store.m_Velocity[index])
+    , m_Target(store.m_Target[index])
+    , m_TimeSinceAttack(store.m_TimeSinceAttack[index])
+    , m_PendingDamage(store.m_PendingDamage[index])
 {
-    pickTarget();
-    m_TimeSinceAttack += deltaTSec;
-    if (targetInRange() && (m_TimeSinceAttack > m_Stats.getAttackTime()))
-    {
-        char buff[200];
-
-        const int damage = (int)((float)m_Stats.getDamage() * DAMAGE_MULTIPLIER);
+    assert(index < store.size());
+}
 
-        snprintf(buff, 200, "%s %s attacks %s %s for %d damage.\n",
-                 m_bNorth ? "North" : "South",
-                 m_Stats.getName(),
-                 m_pTarget->isNorth() ? "North" : "South",
-                 m_pTarget->getStats().getName(),
-                 damage);
-        std::cout << buff;
+Entity::Entity(const EntityRef& ref)
+    : Entity(*ref.m_pStore, (unsigned int)ref.m_Index)
+{
+    assert(ref.isValid());
+}
 
-        m_bTargetLock = true;
-        m_pTarget->takeDamage(damage);
+void Entity::tickTargeting(float deltaTSec, MatchArena& arena)
+{
+    pickTarget(arena);
+    m_TimeSinceAttack += deltaTSec;
+    if (targetInRange() && (m_TimeSinceAttack > m_StatRow.m_AttackTime))
+    {
+        arena.getCounters().add(Attacks, getStatIndex());
+        m_Target.m_bLocked = true;
+        m_PendingDamage = (int)((float)m_StatRow.m_Damage * DAMAGE_MULTIPLIER);
         m_TimeSinceAttack = 0.f;
     }
 }
 
-void Entity::pickTarget()
+void Entity::dealDamage(MatchArena& arena)
 {
-    assert(!m_bTargetLock || !!m_pTarget);
-    if (m_bTargetLock && !m_pTarget->isDead())
+    // Nothing is removed until the end of the tick, so our target is still 
+    //  there (although somebody else may have killed it already).
+    assert(m_PendingDamage > 0);
+    assert(hasTarget());
+
+    const int damage = m_PendingDamage;
+    m_PendingDamage = 0;
+
+    Game& game = getGame();
+    CombatLog& log = game.getCombatLog();
+    GameEventBus& events = game.getEvents();
+
+    Entity target = getTarget();
+    log.logAttack(*this, target, damage);
+
+    const bool bWasDead = target.isDead();
+    target.takeDamage(damage);
+    log.logDamage(target, *this);
+    events.publishDamaged(target, *this, damage);
+    if (!bWasDead && target.isDead())
     {
-        return;
+        arena.getCounters().add(Deaths, target.getStatIndex());
+        log.logDeath(target, *this);
+        events.publishDied(target, *this);
+        if (target.isBuilding())
+        {
+            events.publishTowerDestroyed(target, *this);
+            game.onBuildingDestroyed();
+        }
     }
+}
 
-    m_pTarget = NULL;
-    m_bTargetLock = false;
+void Entity::pickTarget(MatchArena& arena)
+{
+    // If our locked target died, it may already have been removed from its
+    //  store, in which case our handle to it no longer finds anything.
+    if (m_Target.m_bLocked && hasTarget() && !getTarget().isDead())
+    {
+        arena.getCounters().add(TargetCacheHits, getStatIndex());
+        return;
+    }
 
-    Game& game = Game::get();
+    clearTarget();
+    arena.getCounters().add(TargetScans, getStatIndex());
+    EntityStore* pClosestStore = NULL;
+    unsigned int closestIndex = 0;
 
     float closestDistSq = FLT_MAX;
 
-    Player& opposingPlayer = Game::get().getPlayer(!m_bNorth);
+    Game& game = getGame();
+    Player& opposingPlayer = game.getPlayer(!isNorth());
 
-    for (Entity* pEntity : opposingPlayer.getBuildings())
+    EntityStore& buildings = opposingPlayer.getBuildings();
+    assert(buildings.isNorth() != isNorth());
+    for (unsigned int i = 0; i < buildings.size(); ++i)
     {
-        assert(pEntity->isNorth() != isNorth());
-        if (!pEntity->isDead())
+        if (buildings.m_Health[i] > 0)
         {
-            float distSq = m_Pos.distSqr(pEntity->getPosition());
+            float distSq = m_Pos.distSqr(buildings.m_Pos[i]);
             if (distSq < closestDistSq)
             {
                 closestDistSq = distSq;
-                m_pTarget = pEntity;
+                pClosestStore = &buildings;
+                closestIndex = i;
             }
         }
     }
 
-    if (m_Stats.getTargetType() != iEntityStats::Building)
+    if (m_StatRow.m_TargetType != iEntityStats::Building)
     {
-        for (Entity* pEntity : opposingPlayer.getMobs())
+        EntityStore& mobs = opposingPlayer.getMobs();
+        assert(mobs.isNorth() != isNorth());
+
+        // A mob only wins if it's strictly closer than the closest building.
+        if (game.getUseMobGrid())
+        {
+            const int closestMob = findClosestMob(mobs, closestDistSq, arena);
+            if (closestMob >= 0)
+            {
+                pClosestStore = &mobs;
+                closestIndex = (unsigned int)closestMob;
+            }
+        }
+        else
         {
-            assert(pEntity->isNorth() != isNorth());
-            if (!pEntity->isDead())
+            for (unsigned int i = 0; i < mobs.size(); ++i)
             {
-                float distSq = m_Pos.distSqr(pEntity->getPosition());
-                if (distSq < closestDistSq)
+                if (mobs.m_Health[i] > 0)
                 {
-                    closestDistSq = distSq;
-                    m_pTarget = pEntity;
+                    float distSq = m_Pos.distSqr(mobs.m_Pos[i]);
+                    if (distSq < closestDistSq)
+                    {
+                        closestDistSq = distSq;
+                        pClosestStore = &mobs;
+                        closestIndex = i;
+                    }
                 }
             }
         }
     }
+
+    if (pClosestStore)
+    {
+        setTarget(*pClosestStore, closestIndex);
+    }
 }
 
-bool Entity::targetInRange()
+int Entity::findClosestMob(const EntityStore& mobs, float maxDistSq, MatchArena& arena)
 {
-    if (!!m_pTarget)
+    // Search the target grid outward from us, one ring of cells at a time, and
+    //  stop once everything that's left is too far away to matter.  This must
+    //  pick exactly the mob the brute force loop in pickTarget() would: the 
+    //  closest living one, and of those the one that comes first in the store.
+    //
+    // NOTE: Each ring only gets searched if it could hold something closer 
+    //  than the best candidate found so far, so once we've found a mob the 
+    //  search stops within a ring or two of it.  We only go further out when 
+    //  the nearest enemy really is further away.
+    const SpatialGrid& grid = getGame().getTargetGrid(mobs.isNorth());
+    std::vector<unsigned int>& candidates = arena.getCandidates();
+
+    int closestIndex = -1;
+    float closestDistSq = maxDistSq;
+
+    const int maxRing = grid.getMaxRing(m_Pos);
+    for (int ring = 0; ring <= maxRing; ++ring)
     {
-        float range = m_Stats.getAttackRange();
+        // Pad the bound a little, so that rounding in distSqr() can't make us
+        //  stop before a mob that's right on the edge.
+        const float ringDist = std::max(0.f, grid.getRingDist(ring) - 0.01f);
+        if ((ringDist * ringDist) > closestDistSq)
+        {
+            break;
+        }
 
-        if (m_Stats.getDamageType() == iEntityStats::Melee)
+        candidates.clear();
+        grid.gatherRing(m_Pos, ring, candidates);
+        for (unsigned int i : candidates)
         {
-            range += ((m_Stats.getSize() + m_pTarget->getStats().getSize()) / 2.f);
+            const EntityRef& ref = grid.getEntity(i);
+            if ((ref.m_pStore != &mobs) || (mobs.m_Health[ref.m_Index] <= 0))
+                continue;
+
+            const float distSq = m_Pos.distSqr(mobs.m_Pos[ref.m_Index]);
+            if ((distSq < closestDistSq) ||
+                ((distSq == closestDistSq) && (closestIndex >= 0) && (ref.m_Index < closestIndex)))
+            {
+                closestDistSq = distSq;
+                closestIndex = ref.m_Index;
+            }
         }
+    }
 
-        return m_Pos.distSqr(m_pTarget->getPosition()) <= (range * range);
+    return closestIndex;
+}
+
+void Entity::setTarget(EntityStore& store, unsigned int index)
+{
+    m_Target.m_pStore = &store;
+    m_Target.m_Handle = store.getHandle(index);
+}
+
+void Entity::clearTarget()
+{
+    m_Target.m_pStore = NULL;
+    m_Target.m_Handle = EntityHandle();
+    m_Target.m_bLocked = false;
+}
+
+bool Entity::targetInRange()
+{
+    if (hasTarget())
+    {
+        // Melee attackers get to add both half sizes to their range, which
+        //  the pair table has already done for us.
+        Entity target = getTarget();
+        const EntityPairStats& pair = getPairStats(getStatIndex(), target.getStatIndex());
+        return m_Pos.distSqr(target.getPosition()) <= pair.m_AttackRangeSq;
     }
 
     return false;
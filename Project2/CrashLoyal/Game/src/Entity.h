@@ -23,49 +23,92 @@
 #pragma once
 
 #include "EntityStats.h"
+#include "EntityStore.h"
 #include "iPlayer.h"
 #include "Vec2.h"
 
+class Game;
+class MatchArena;
+
+// A view onto one entity in an EntityStore.  The data lives in the store; 
+// this just knows where to find it, and what to do with it.  Views are cheap
+// to make, and are only good until the store is added to or has its dead
+// removed, so make one when you need it and then let it go.
 class Entity 
 {
 
 public:
-    Entity(const iEntityStats& stats, const Vec2& pos, bool isNorth);
-    virtual ~Entity() {}
+    Entity(EntityStore& store, unsigned int index);
+    explicit Entity(const EntityRef& ref);
+
+    // NOTE: Prefer getStatRow() in anything that runs every tick.
+    const iEntityStats& getStats() const { return m_Store.getStats(m_Index); }
+    const EntityStatRow& getStatRow() const { return m_StatRow; }
+    int getStatIndex() const { return m_Store.m_Type[m_Index]; }
 
-    virtual const iEntityStats& getStats() const { return m_Stats; }
+    // Picks our target, and decides whether to attack it.  The damage is 
+    //  dealt later, by dealDamage(), so that everybody picks their targets 
+    //  from the same state.
+    void tickTargeting(float deltaTSec, MatchArena& arena);
+    void dealDamage(MatchArena& arena);
 
-    virtual void tick(float deltaTSec);
+    Game& getGame() const { return m_Store.getGame(); }
 
-    virtual bool isNorth() const { return m_bNorth; }
+    bool isNorth() const { return m_Store.isNorth(); }
+    bool isBuilding() const { return m_Store.holdsBuildings(); }
 
-    virtual bool isDead() const { return m_Health <= 0; }
-    virtual int getHealth() const { return m_Health; }
+    bool isDead() const { return m_Health <= 0; }
+    int getHealth() const { return m_Health; }
     void takeDamage(int dmg) { m_Health -= dmg; }
 
-    virtual const Vec2& getPosition() const { return m_Pos; }
+    const Vec2& getPosition() const { return m_Pos; }
+
+    iPlayer::EntityData getData() const { return m_Store.getData(m_Index); }
 
-    iPlayer::EntityData getData() const { return iPlayer::EntityData(m_Stats, m_Health, m_Pos); }
+    const Vec2& getVelocity() const { return m_Velocity; }
 
-    virtual const Vec2& getVelocity() const { return m_Velocity; }
+    EntityRef getRef() const { return EntityRef(&m_Store, (int)m_Index); }
+    EntityHandle getHandle() const { return m_Store.getHandle(m_Index); }
 
-    Vec2 m_Pos;
+    Vec2& m_Pos;
 
 protected:
-    void pickTarget();
+    // NOTE: For views that are going to write somewhere other than the 
+    //  entity's current position (see Mob).
+    Entity(EntityStore& store, unsigned int index, Vec2& pos);
+
+    void pickTarget(MatchArena& arena);
     bool targetInRange();
 
+    // Where our target is right now - invalid if we don't have one, or if
+    //  it has died and been removed.
+    EntityRef getTargetRef() const
+    {
+        return m_Target.m_pStore ? EntityRef(m_Target.m_pStore, m_Target.m_pStore->find(m_Target.m_Handle)) : EntityRef();
+    }
+
+    bool hasTarget() const { return getTargetRef().isValid(); }
+
+    // Only call this if hasTarget()
+    Entity getTarget() const { return Entity(getTargetRef()); }
+
+    void setTarget(EntityStore& store, unsigned int index);
+
+    // Returns the index of the closest living mob in mobs that's strictly 
+    //  closer than maxDistSq (or -1).  Uses Game::getTargetGrid().
+    int findClosestMob(const EntityStore& mobs, float maxDistSq, MatchArena& arena);
+    void clearTarget();
+
 protected:
-    const iEntityStats& m_Stats;
-    bool m_bNorth;
-    int m_Health;
-    Vec2 m_Velocity;
+    EntityStore& m_Store;
+    unsigned int m_Index;
+
+    const EntityStatRow& m_StatRow;
+    int& m_Health;
+    Vec2& m_Velocity;
     // float m_maxAcceleration;
 
-    // Our target will be the closest target (may change every tick) until
-    //  we attack it.  Once we attack a target, we stay locked on it until
-    //  it dies
-    Entity* m_pTarget;
-    bool m_bTargetLock;
-    float m_TimeSinceAttack;
+    EntityTarget& m_Target;
+    float& m_TimeSinceAttack;
+    int& m_PendingDamage;
 };
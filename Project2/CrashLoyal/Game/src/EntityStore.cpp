@@ -0,0 +1,249 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "EntityStore.h"
+
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <assert.h>
+
+// How a target is saved in a snapshot, since the store pointer won't mean 
+//  anything later.
+struct SavedTarget
+{
+    unsigned char m_Store;      // EntityStore::getStoreCode(), or ksNoStore
+    unsigned char m_bLocked;
+    unsigned char m_Pad[2];
+    EntityHandle m_Handle;
+};
+static const unsigned char ksNoStore = 0xFF;
+
+EntityStore::EntityStore(Game& game, bool bNorth, bool bBuildings)
+    : m_Game(game)
+    , m_bNorth(bNorth)
+    , m_bBuildings(bBuildings)
+{
+}
+
+unsigned int EntityStore::add(const iEntityStats& stats, const Vec2& pos)
+{
+    if (m_bBuildings)
+    {
+        assert(dynamic_cast<const iEntityStats_Building*>(&stats) != NULL);
+        m_Type.push_back(getStatIndex(stats.getBuildingType()));
+    }
+    else
+    {
+        assert(dynamic_cast<const iEntityStats_Mob*>(&stats) != NULL);
+        m_Type.push_back(getStatIndex(stats.getMobType()));
+    }
+
+    m_Pos.push_back(pos);
+    m_NextPos.push_back(pos);
+    m_Velocity.push_back(Vec2(0, 0));
+    m_Health.push_back(stats.getMaxHealth());
+    m_TimeSinceAttack.push_back(0.f);
+    m_Target.push_back(EntityTarget());
+    m_PendingDamage.push_back(0);
+    m_Steering.push_back(MobSteering());
+
+    // Reuse a dead entity's slot if we have one, otherwise make a new one.
+    const unsigned int index = size() - 1;
+    unsigned int slot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = (unsigned int)m_SlotIndex.size();
+        m_SlotIndex.push_back(-1);
+        m_SlotGeneration.push_back(0);
+    }
+
+    assert(m_SlotIndex[slot] < 0);
+    m_SlotIndex[slot] = (int)index;
+    m_Slot.push_back(slot);
+
+    return index;
+}
+
+bool EntityStore::removeDead()
+{
+    unsigned int newIndex = 0;
+    for (unsigned int oldIndex = 0; oldIndex < size(); ++oldIndex)
+    {
+        const unsigned int slot = m_Slot[oldIndex];
+        if (isDead(oldIndex))
+        {
+            // Free the slot, and make sure that handles to it stop matching.
+            m_SlotIndex[slot] = -1;
+            ++m_SlotGeneration[slot];
+            m_FreeSlots.push_back(slot);
+            continue;
+        }
+
+        if (newIndex != oldIndex)
+        {
+            moveEntity(oldIndex, newIndex);
+            m_SlotIndex[slot] = (int)newIndex;
+        }
+        ++newIndex;
+    }
+
+    const bool bRemovedAny = (newIndex < size());
+    resize(newIndex);
+    return bRemovedAny;
+}
+
+void EntityStore::clear()
+{
+    std::fill(m_Health.begin(), m_Health.end(), 0);
+    removeDead();
+}
+
+const iEntityStats& EntityStore::getStats(unsigned int i) const
+{
+    const EntityStatRow& row = getStatRow(i);
+    if (m_bBuildings)
+    {
+        return iEntityStats::getBuildingStats(row.m_BuildingType);
+    }
+
+    return iEntityStats::getStats(row.m_MobType);
+}
+
+void EntityStore::reserve(unsigned int capacity)
+{
+    m_Type.reserve(capacity);
+    m_Pos.reserve(capacity);
+    m_NextPos.reserve(capacity);
+    m_Velocity.reserve(capacity);
+    m_Health.reserve(capacity);
+    m_TimeSinceAttack.reserve(capacity);
+    m_Target.reserve(capacity);
+    m_PendingDamage.reserve(capacity);
+    m_Steering.reserve(capacity);
+    m_Slot.reserve(capacity);
+    m_SlotIndex.reserve(capacity);
+    m_SlotGeneration.reserve(capacity);
+    m_FreeSlots.reserve(capacity);
+}
+
+void EntityStore::moveEntity(unsigned int from, unsigned int to)
+{
+    m_Type[to] = m_Type[from];
+    m_Pos[to] = m_Pos[from];
+    m_NextPos[to] = m_NextPos[from];
+    m_Velocity[to] = m_Velocity[from];
+    m_Health[to] = m_Health[from];
+    m_TimeSinceAttack[to] = m_TimeSinceAttack[from];
+    m_Target[to] = m_Target[from];
+    m_PendingDamage[to] = m_PendingDamage[from];
+    m_Steering[to] = m_Steering[from];
+    m_Slot[to] = m_Slot[from];
+}
+
+void EntityStore::resize(unsigned int newSize)
+{
+    m_Type.resize(newSize);
+    m_Pos.resize(newSize);
+    m_NextPos.resize(newSize);
+    m_Velocity.resize(newSize);
+    m_Health.resize(newSize);
+    m_TimeSinceAttack.resize(newSize);
+    m_Target.resize(newSize);
+    m_PendingDamage.resize(newSize);
+    m_Steering.resize(newSize);
+    m_Slot.resize(newSize);
+}
+
+void EntityStore::save(SnapshotWriter& writer) const
+{
+    writer.write(size());
+    writer.writeElements(m_Type);
+    writer.writeElements(m_Pos);
+    writer.writeElements(m_NextPos);
+    writer.writeElements(m_Velocity);
+    writer.writeElements(m_Health);
+    writer.writeElements(m_TimeSinceAttack);
+    writer.writeElements(m_PendingDamage);
+    writer.writeElements(m_Steering);
+    writer.writeElements(m_Slot);
+
+    for (const EntityTarget& target : m_Target)
+    {
+        SavedTarget saved = {};
+        saved.m_Store = target.m_pStore ? (unsigned char)target.m_pStore->getStoreCode() : ksNoStore;
+        saved.m_bLocked = target.m_bLocked;
+        saved.m_Handle = target.m_Handle;
+        writer.write(saved);
+    }
+
+    writer.writeVector(m_SlotIndex);
+    writer.writeVector(m_SlotGeneration);
+    writer.writeVector(m_FreeSlots);
+}
+
+bool EntityStore::restore(SnapshotReader& reader, EntityStore* const* ppStores)
+{
+    unsigned int newSize;
+    if (!reader.read(newSize))
+        return false;
+
+    reader.readElements(m_Type, newSize);
+    reader.readElements(m_Pos, newSize);
+    reader.readElements(m_NextPos, newSize);
+    reader.readElements(m_Velocity, newSize);
+    reader.readElements(m_Health, newSize);
+    reader.readElements(m_TimeSinceAttack, newSize);
+    reader.readElements(m_PendingDamage, newSize);
+    reader.readElements(m_Steering, newSize);
+    reader.readElements(m_Slot, newSize);
+
+    m_Target.resize(newSize);
+    for (EntityTarget& target : m_Target)
+    {
+        SavedTarget saved;
+        if (!reader.read(saved) || ((saved.m_Store != ksNoStore) && (saved.m_Store >= 4)))
+            return false;
+
+        target.m_pStore = (saved.m_Store != ksNoStore) ? ppStores[saved.m_Store] : NULL;
+        target.m_bLocked = (saved.m_bLocked != 0);
+        target.m_Handle = saved.m_Handle;
+    }
+
+    reader.readVector(m_SlotIndex);
+    reader.readVector(m_SlotGeneration);
+    reader.readVector(m_FreeSlots);
+    if (!reader.isOk() || (m_SlotIndex.size() != m_SlotGeneration.size()))
+        return false;
+
+    for (unsigned int i = 0; i < newSize; ++i)
+    {
+        if ((m_Type[i] < 0) || (m_Type[i] >= NUM_STAT_TYPES) || (m_Slot[i] >= m_SlotIndex.size()))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,194 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityHandle.h"
+#include "EntityStats.h"
+#include "EntityStatTable.h"
+#include "iPlayer.h"
+#include "Vec2.h"
+
+#include <vector>
+
+class EntityStore;
+class Game;
+class SnapshotReader;
+class SnapshotWriter;
+
+// Identifies a single entity: the store that it lives in, and its index in
+// that store.  Indices change when dead mobs are removed from a store (see 
+// EntityStore::removeDead()), so an EntityRef is only good until then - use 
+// it for things like query results, which are thrown away right after.  
+// Anything that has to last across ticks should hold an EntityHandle.
+struct EntityRef
+{
+    EntityRef() : m_pStore(NULL), m_Index(-1) {}
+    EntityRef(EntityStore* pStore, int index) : m_pStore(pStore), m_Index(index) {}
+
+    bool isValid() const { return !!m_pStore && (m_Index >= 0); }
+
+    bool operator==(const EntityRef& rhs) const { return (m_pStore == rhs.m_pStore) && (m_Index == rhs.m_Index); }
+    bool operator!=(const EntityRef& rhs) const { return !(*this == rhs); }
+
+    EntityStore* m_pStore;
+    int m_Index;
+};
+
+// Who an entity is after.  Our target will be the closest target (may change 
+// every tick) until we attack it.  Once we attack a target, we stay locked 
+// on it until it dies.
+struct EntityTarget
+{
+    EntityTarget() : m_pStore(NULL), m_bLocked(false) {}
+
+    EntityStore* m_pStore;      // the store that our target lives in
+    EntityHandle m_Handle;
+    bool m_bLocked;
+};
+
+// Where a mob was last headed, and what was blocking it.  These are saved 
+// in snapshots as they are, so the padding is spelled out and kept zeroed.
+struct MobSteering
+{
+    MobSteering() : m_bXStop(false), m_bYStop(false), m_bMoving(false), m_Pad(0) {}
+
+    Vec2 m_TargetPos;       // where we were headed last tick
+    bool m_bXStop;          // blocked in x by the river, a building or the map edge
+    bool m_bYStop;          // blocked in y by a building or the map edge
+    bool m_bMoving;         // moved this tick, rather than attacking
+    unsigned char m_Pad;
+};
+static_assert(sizeof(MobSteering) == (sizeof(Vec2) + 4), "MobSteering can't have any padding that isn't m_Pad");
+
+// Structure-of-arrays storage for one player's mobs, or one player's 
+// buildings.  Each field lives in its own contiguous array, and entity i is
+// index i in every array, so the hot loops (targeting, movement, collision)
+// can walk just the fields that they need from front to back.
+//
+// Entity, Mob and Building are lightweight views onto one index in a store. 
+// They're cheap to make, so make one whenever you need one, and don't hang 
+// onto them - they're invalidated whenever the store is added to or has its
+// dead removed.
+class EntityStore
+{
+public:
+    EntityStore(Game& game, bool bNorth, bool bBuildings);
+
+    // The match that we're part of.
+    Game& getGame() const { return m_Game; }
+
+    bool isNorth() const { return m_bNorth; }
+    bool holdsBuildings() const { return m_bBuildings; }
+
+    unsigned int size() const { return (unsigned int)m_Pos.size(); }
+
+    // Makes room for this many entities, so that adding them won't allocate.
+    //  Removing entities never gives the room back.
+    void reserve(unsigned int capacity);
+
+    // Adds a new entity to the end of the store.  Returns its index.
+    unsigned int add(const iEntityStats& stats, const Vec2& pos);
+
+    // Removes every dead entity.  The survivors keep their relative order 
+    //  (but not their indices).  Returns true if anything was removed.
+    bool removeDead();
+
+    // Removes every entity.  Handles to them stop matching, just as if they 
+    //  had died.
+    void clear();
+
+    // Handles stay good until their entity is removed.
+    EntityHandle getHandle(unsigned int i) const { return EntityHandle(m_Slot[i], m_SlotGeneration[m_Slot[i]]); }
+
+    // Returns the index of the entity with the given handle, or -1 if it has
+    //  been removed.
+    int find(const EntityHandle& handle) const
+    {
+        if ((handle.m_Slot < m_SlotGeneration.size()) && (m_SlotGeneration[handle.m_Slot] == handle.m_Generation))
+        {
+            return m_SlotIndex[handle.m_Slot];
+        }
+        return -1;
+    }
+
+    // The hot loops should use getStatRow() - getStats() is for handing to 
+    //  code that wants the iEntityStats interface.
+    const iEntityStats& getStats(unsigned int i) const;
+    const EntityStatRow& getStatRow(unsigned int i) const { return ENTITY_STATS[m_Type[i]]; }
+    bool isDead(unsigned int i) const { return m_Health[i] <= 0; }
+    iPlayer::EntityData getData(unsigned int i) const { return iPlayer::EntityData(getStats(i), m_Health[i], m_Pos[i], getHandle(i)); }
+
+    // Which of the four stores (North/South, buildings/mobs) this is, from 0
+    //  to 3.  Snapshots use it to save where targets are.
+    unsigned int getStoreCode() const { return (m_bNorth ? 0 : 2) + (m_bBuildings ? 0 : 1); }
+
+    // Writes out every entity, and the handle slots, so that restore() puts
+    //  the store back exactly as it was.  ppStores holds all four stores, 
+    //  indexed by getStoreCode(), for finding targets with.  restore() 
+    //  returns false if the snapshot doesn't make sense.
+    void save(SnapshotWriter& writer) const;
+    bool restore(SnapshotReader& reader, EntityStore* const* ppStores);
+
+    // Positions are double buffered while the mobs move (see Game::tick()).
+    //  beginTick() starts every mob off where it is.  The mobs move to 
+    //  m_NextPos, and then their collisions are resolved back into m_Pos.
+    void beginTick() { m_NextPos = m_Pos; }
+
+public:
+    // The fields.  All of these have size() elements.
+    std::vector<int> m_Type;                // index into ENTITY_STATS (see getStatIndex())
+    std::vector<Vec2> m_Pos;
+    std::vector<Vec2> m_NextPos;            // where each mob moved to this tick, before collisions
+    std::vector<Vec2> m_Velocity;
+    std::vector<int> m_Health;
+    std::vector<float> m_TimeSinceAttack;
+    std::vector<EntityTarget> m_Target;
+    std::vector<int> m_PendingDamage;       // to be dealt to our target (see Entity::dealDamage())
+
+    // Only used by mobs
+    std::vector<MobSteering> m_Steering;
+
+    // Which slot each entity's handles point at
+    std::vector<unsigned int> m_Slot;
+
+private:
+    void moveEntity(unsigned int from, unsigned int to);
+    void resize(unsigned int newSize);
+
+private:
+    Game& m_Game;
+    bool m_bNorth;
+    bool m_bBuildings;
+
+    // The slots that handles refer to.  A slot holds the current index of its
+    //  entity (or -1 if it's free), and a generation that goes up every time
+    //  the slot is freed, so that handles to the old occupant stop matching.
+    std::vector<int> m_SlotIndex;
+    std::vector<unsigned int> m_SlotGeneration;
+    std::vector<unsigned int> m_FreeSlots;
+
+private:
+    // DELIBERATELY UNDEFINED
+    EntityStore(const EntityStore& rhs);
+    EntityStore& operator=(const EntityStore& rhs);
+};
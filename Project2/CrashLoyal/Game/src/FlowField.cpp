@@ -0,0 +1,219 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "FlowField.h"
+
+#include "CollisionField.h"
+#include "Constants.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cfloat>
+#include <functional>
+
+// Half a meter, the same as the collision field, so that the bridges are a 
+//  few tiles wide.
+static const float ksTileSize = 0.5f;
+static const float ksInvTileSize = 1.f / ksTileSize;
+
+// How much more it costs to walk through the river or a tower than around.
+static const float ksBlockedCostMultiplier = 50.f;
+
+static const float ksDiagonalCost = 1.41421356f;
+
+// Orthogonal neighbors first, so that they win ties.
+static const int ksNumNeighbors = 8;
+static const int ksNeighborX[ksNumNeighbors] = { 0, 1, 0, -1, 1, 1, -1, -1 };
+static const int ksNeighborY[ksNumNeighbors] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+FlowField::FlowField()
+    : m_NumTilesX((int)(GAME_GRID_WIDTH * ksInvTileSize))
+    , m_NumTilesY((int)(GAME_GRID_HEIGHT * ksInvTileSize))
+{
+    const int numTiles = m_NumTilesX * m_NumTilesY;
+    m_Blocked.resize(numTiles);
+    m_Directions[0].resize(numTiles);
+    m_Directions[1].resize(numTiles);
+    m_Cost.resize(numTiles);
+
+    // Every tile goes in once to start with (if it's a goal) or once for each
+    //  of its neighbors (at most), so rebuilding mid-match won't allocate.
+    m_Open.reserve(numTiles * (ksNumNeighbors + 1));
+}
+
+void FlowField::build(const CollisionField& collision, float mobRadius)
+{
+    // A tile is blocked if a mob could be touching the river or a tower 
+    //  from anywhere in it.
+    for (int y = 0; y < m_NumTilesY; ++y)
+    {
+        for (int x = 0; x < m_NumTilesX; ++x)
+        {
+            const Vec2 minPt((float)x * ksTileSize, (float)y * ksTileSize);
+            const Vec2 maxPt(minPt.x + ksTileSize, minPt.y + ksTileSize);
+
+            bool bBlocked = collision.overlapsRiver(minPt, maxPt);
+            for (unsigned int i = 0; !bBlocked && (i < collision.getNumTowers()); ++i)
+            {
+                const Vec2& towerPos = collision.getTowerPosition(i);
+                const float reach = collision.getTowerHalfSize(i) + mobRadius;
+                bBlocked = (maxPt.x >= towerPos.x - reach) && (minPt.x <= towerPos.x + reach)
+                    && (maxPt.y >= towerPos.y - reach) && (minPt.y <= towerPos.y + reach);
+            }
+
+            m_Blocked[(y * m_NumTilesX) + x] = bBlocked;
+        }
+    }
+
+    buildField(true);
+    buildField(false);
+}
+
+void FlowField::buildField(bool bToNorth)
+{
+    // Dijkstra's algorithm, outward from every tile in the goal half.
+    // NOTE: A tile is in a half if its center is, using the same test as 
+    //  Mob::move(), so the field hands mobs off exactly where they start 
+    //  walking straight at their target.
+    typedef std::pair<float, int> OpenTile;
+    m_Open.clear();
+    for (int y = 0; y < m_NumTilesY; ++y)
+    {
+        const float centerY = ((float)y + 0.5f) * ksTileSize;
+        const bool bGoal = (centerY < (GAME_GRID_HEIGHT / 2)) == bToNorth;
+        for (int x = 0; x < m_NumTilesX; ++x)
+        {
+            const int tile = (y * m_NumTilesX) + x;
+            m_Cost[tile] = bGoal ? 0.f : FLT_MAX;
+            if (bGoal)
+            {
+                m_Open.push_back(OpenTile(0.f, tile));
+            }
+        }
+    }
+    std::make_heap(m_Open.begin(), m_Open.end(), std::greater<OpenTile>());
+
+    while (!m_Open.empty())
+    {
+        std::pop_heap(m_Open.begin(), m_Open.end(), std::greater<OpenTile>());
+        const OpenTile current = m_Open.back();
+        m_Open.pop_back();
+        if (current.first > m_Cost[current.second])
+        {
+            continue;   // we've already found a cheaper way here
+        }
+
+        // Walking from a neighbor into this tile.
+        const int x = current.second % m_NumTilesX;
+        const int y = current.second / m_NumTilesX;
+        for (int i = 0; i < ksNumNeighbors; ++i)
+        {
+            const int fromX = x + ksNeighborX[i];
+            const int fromY = y + ksNeighborY[i];
+            if (!canStep(fromX, fromY, -ksNeighborX[i], -ksNeighborY[i]))
+            {
+                continue;
+            }
+
+            const int from = (fromY * m_NumTilesX) + fromX;
+            const float cost = current.first + getStepCost(current.second, ksNeighborX[i], ksNeighborY[i]);
+            if (cost < m_Cost[from])
+            {
+                m_Cost[from] = cost;
+                assert(m_Open.size() < m_Open.capacity());
+                m_Open.push_back(OpenTile(cost, from));
+                std::push_heap(m_Open.begin(), m_Open.end(), std::greater<OpenTile>());
+            }
+        }
+    }
+
+    // Point each tile at its cheapest neighbor.
+    std::vector<Vec2>& directions = m_Directions[bToNorth ? 1 : 0];
+    for (int y = 0; y < m_NumTilesY; ++y)
+    {
+        for (int x = 0; x < m_NumTilesX; ++x)
+        {
+            const int tile = (y * m_NumTilesX) + x;
+            directions[tile] = Vec2(0.f, 0.f);
+            if (m_Cost[tile] == 0.f)
+            {
+                continue;
+            }
+
+            float bestCost = FLT_MAX;
+            for (int i = 0; i < ksNumNeighbors; ++i)
+            {
+                if (!canStep(x, y, ksNeighborX[i], ksNeighborY[i]))
+                {
+                    continue;
+                }
+
+                const int to = ((y + ksNeighborY[i]) * m_NumTilesX) + x + ksNeighborX[i];
+                const float cost = m_Cost[to] + getStepCost(to, ksNeighborX[i], ksNeighborY[i]);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    directions[tile] = Vec2((float)ksNeighborX[i], (float)ksNeighborY[i]);
+                }
+            }
+            directions[tile].normalize();
+        }
+    }
+}
+
+int FlowField::getTile(const Vec2& pos) const
+{
+    // Mobs can be shoved off the edge of the map, so clamp.
+    const int x = std::max(0, std::min(m_NumTilesX - 1, (int)(pos.x * ksInvTileSize)));
+    const int y = std::max(0, std::min(m_NumTilesY - 1, (int)(pos.y * ksInvTileSize)));
+    return (y * m_NumTilesX) + x;
+}
+
+bool FlowField::canStep(int fromX, int fromY, int dx, int dy) const
+{
+    const int toX = fromX + dx;
+    const int toY = fromY + dy;
+    if ((fromX < 0) || (fromX >= m_NumTilesX) || (fromY < 0) || (fromY >= m_NumTilesY)
+        || (toX < 0) || (toX >= m_NumTilesX) || (toY < 0) || (toY >= m_NumTilesY))
+    {
+        return false;
+    }
+
+    // No cutting diagonally past the corner of something blocked.
+    if ((dx != 0) && (dy != 0))
+    {
+        return !m_Blocked[(fromY * m_NumTilesX) + toX] && !m_Blocked[(toY * m_NumTilesX) + fromX];
+    }
+
+    return true;
+}
+
+float FlowField::getStepCost(int toTile, int dx, int dy) const
+{
+    const float cost = ((dx != 0) && (dy != 0)) ? ksDiagonalCost : 1.f;
+    return m_Blocked[toTile] ? (cost * ksBlockedCostMultiplier) : cost;
+}
+
+const Vec2& FlowField::getDirection(bool bToNorth, const Vec2& pos) const
+{
+    return m_Directions[bToNorth ? 1 : 0][getTile(pos)];
+}
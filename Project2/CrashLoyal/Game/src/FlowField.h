@@ -0,0 +1,69 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Vec2.h"
+#include <utility>
+#include <vector>
+
+class CollisionField;
+
+// Tells a mob which way to walk to get to one half of the arena - across a 
+//  bridge, and around the towers - with a single lookup.  There's a field for
+//  each half: mobs whose target is across the river follow the field for the 
+//  target's half until they get there, and then walk straight at it.
+//
+// Each field stores a direction for every tile, pointing at the neighboring 
+//  tile that's on the shortest path to the goal half.  The river and the live 
+//  towers are very expensive to walk through rather than impassable, so a mob
+//  that has been shoved into one is led out the shortest way.
+class FlowField
+{
+public:
+    FlowField();
+
+    // Call this when the match starts and whenever a tower is destroyed.
+    //  Mobs keep their centers this far from the towers.
+    void build(const CollisionField& collision, float mobRadius);
+
+    // The way to walk (unit length) from pos to reach the north or south half
+    //  of the arena, or (0, 0) if pos is already there.
+    const Vec2& getDirection(bool bToNorth, const Vec2& pos) const;
+
+private:
+    void buildField(bool bToNorth);
+    int getTile(const Vec2& pos) const;
+    bool canStep(int fromX, int fromY, int dx, int dy) const;
+    float getStepCost(int toTile, int dx, int dy) const;
+
+private:
+    int m_NumTilesX;
+    int m_NumTilesY;
+
+    std::vector<bool> m_Blocked;
+    std::vector<Vec2> m_Directions[2];  // [bToNorth]
+
+    // Scratch space for building the fields.
+    std::vector<float> m_Cost;
+    std::vector<std::pair<float, int>> m_Open;
+};
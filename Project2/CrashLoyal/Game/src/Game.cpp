@@ -22,89 +22,581 @@
 
 #include "Game.h"
 
+#include <algorithm>
 #include <cmath>
 #include "Building.h"
 #include "Constants.h"
 #include "Controller_AI_KevinDill.h"
+#ifndef CRASHLOYAL_HEADLESS
 #include "Controller_UI.h"
+#endif
 #include "Mob.h"
 #include "Player.h"
+#include "Profiler.h"
+#include "Scenario.h"
+#include "Snapshot.h"
 
-Game* Singleton<Game>::s_Obj = NULL;
+// How many entities a thread takes at a time in the parallel phases.  Small
+//  enough to spread a few hundred mobs over a lot of threads, big enough that
+//  handing out the work is cheap next to doing it.
+static const unsigned int ksEntitiesPerChunk = 16;
+
+// Big enough that a search for the closest enemy only has to look at a few
+//  cells, small enough that each cell doesn't have too many mobs in it.
+static const float ksTargetGridCellSize = 2.f;
 
 Game::Game()
-    : gameOverState(0) // No winner at start of game
+    : m_bUseMobGrid(true)
+    , m_MobGrid(1.f)    // 1 meter cells - bigger than any mob
+    , m_NorthTargetGrid(ksTargetGridCellSize)
+    , m_SouthTargetGrid(ksTargetGridCellSize)
+    , m_BroadphaseGrid(1.f)
+    , m_MaxMobSize(0.f)
+    , m_bStaticFieldsDirty(false)
+    , m_pJobSystem(NULL)
+    , m_pArenas(NULL)
+    , m_NumReservedMobs(0)
+    , m_TickGraph(&Game::runTickPhase, &Game::countTickPhase, this)
+    , m_TickDeltaTSec(0.f)
+    , m_TickCount(0)
+    , gameOverState(0) // No winner at start of game
+    , m_bGameOverPublished(false)
 {
+    setNumThreads(0);
+    buildTickGraph();
+
     // FinalProject: This is where you specify which controllers to use - for 
     // instance, if you make two instances of your AI then it will play 
     // itself, or if you make one the UI and one your AI then you can play
     // against your AI.  If you make the controller NULL then that player
     // will just passively sit there and let you kill it.
+#ifdef CRASHLOYAL_HEADLESS
+    // There's nobody to click on anything in a headless build.
+    buildPlayers(new Controller_AI_KevinDill, new Controller_AI_KevinDill);
+#else
     buildPlayers(new Controller_AI_KevinDill, new Controller_UI);
+#endif
 
-    buildWaypoints();
+    findMaxMobSize();
+    buildStaticFields();
+}
+
+Game::Game(iController* pNorthControl, iController* pSouthControl, unsigned int numThreads)
+    : m_bUseMobGrid(true)
+    , m_MobGrid(1.f)    // 1 meter cells - bigger than any mob
+    , m_NorthTargetGrid(ksTargetGridCellSize)
+    , m_SouthTargetGrid(ksTargetGridCellSize)
+    , m_BroadphaseGrid(1.f)
+    , m_MaxMobSize(0.f)
+    , m_bStaticFieldsDirty(false)
+    , m_pJobSystem(NULL)
+    , m_pArenas(NULL)
+    , m_NumReservedMobs(0)
+    , m_TickGraph(&Game::runTickPhase, &Game::countTickPhase, this)
+    , m_TickDeltaTSec(0.f)
+    , m_TickCount(0)
+    , gameOverState(0) // No winner at start of game
+    , m_bGameOverPublished(false)
+{
+    setNumThreads(numThreads);
+    buildTickGraph();
+
+    buildPlayers(pNorthControl, pSouthControl);
+
+    findMaxMobSize();
+    buildStaticFields();
 }
 
 Game::~Game()
 {
     delete m_pNorthPlayer;
     delete m_pSouthPlayer;
+
+    delete[] m_pArenas;
+    delete m_pJobSystem;
+}
+
+void Game::setNumThreads(unsigned int numThreads)
+{
+    delete[] m_pArenas;
+    delete m_pJobSystem;
+
+    m_pJobSystem = new JobSystem(numThreads);
+    m_pArenas = new MatchArena[m_pJobSystem->getNumThreads()];
+    for (unsigned int i = 0; i < m_pJobSystem->getNumThreads(); ++i)
+    {
+        m_pArenas[i].reserve(m_NumReservedMobs);
+    }
+}
+
+void Game::reserve(unsigned int numMobs)
+{
+    m_NumReservedMobs = std::max(m_NumReservedMobs, numMobs);
+
+    // Either side's target grid may end up with all of them.
+    for (SpatialGrid* pGrid : { &m_MobGrid, &m_BroadphaseGrid, &m_NorthTargetGrid, &m_SouthTargetGrid })
+    {
+        pGrid->reserve(m_NumReservedMobs);
+    }
+    for (unsigned int i = 0; i < getNumThreads(); ++i)
+    {
+        m_pArenas[i].reserve(m_NumReservedMobs);
+    }
+
+    // Everybody can be damaged and die in the same tick, and the controllers
+    //  can place a few more.
+    const unsigned int numBuildings = m_pNorthPlayer->getNumBuildings() + m_pSouthPlayer->getNumBuildings();
+    m_Events.reserve((2 * (m_NumReservedMobs + numBuildings)) + ARENA_MOBS_PER_PLAYER);
+}
+
+// Calls func(store, index) for the entities numbered [begin, end), counting 
+//  through the stores one after the other.
+template <typename Func>
+static void forEachEntity(EntityStore* const* ppStores, unsigned int numStores,
+                          unsigned int begin, unsigned int end, const Func& func)
+{
+    unsigned int first = 0;
+    for (unsigned int s = 0; (s < numStores) && (first < end); ++s)
+    {
+        EntityStore& store = *ppStores[s];
+        const unsigned int last = first + store.size();
+        for (unsigned int i = std::max(begin, first); i < std::min(end, last); ++i)
+        {
+            func(store, i - first);
+        }
+        first = last;
+    }
+}
+
+// Dead towers stay in their store until the game is over.
+static unsigned int countLiving(const EntityStore& store)
+{
+    unsigned int numLiving = 0;
+    for (unsigned int i = 0; i < store.size(); ++i)
+    {
+        if (!store.isDead(i))
+            ++numLiving;
+    }
+    return numLiving;
 }
 
 void Game::tick(float deltaTSec)
 {
-    m_pNorthPlayer->tick(deltaTSec);
-    m_pSouthPlayer->tick(deltaTSec);
+    // NOTE: The profiler's tick histogram is made from this scope's times.
+    PROFILE_SCOPE("Tick");
+
+    m_TickDeltaTSec = deltaTSec;
+    m_CombatLog.setTick(m_TickCount);
+    m_Events.beginTick(m_TickCount);
+    m_pJobSystem->run(m_TickGraph);
+    ++m_TickCount;
+
+    // Merge every thread's counts, now that nobody's counting.
+    m_TickCounters.clear();
+    for (unsigned int i = 0; i < getNumThreads(); ++i)
+    {
+        PerfCounterShard& shard = m_pArenas[i].getCounters();
+        m_TickCounters.add(shard);
+        shard.clear();
+    }
+    m_TickCounters.setGauge(NorthMobsGauge, m_pNorthPlayer->getNumMobs());
+    m_TickCounters.setGauge(SouthMobsGauge, m_pSouthPlayer->getNumMobs());
+    m_TickCounters.setGauge(NorthTowersGauge, countLiving(m_pNorthPlayer->getBuildings()));
+    m_TickCounters.setGauge(SouthTowersGauge, countLiving(m_pSouthPlayer->getBuildings()));
+    m_TickCounters.setGauge(TickMsGauge, m_TickGraph.getLastRunTime() * 1000.0);
+    m_MatchCounters.add(m_TickCounters);
+
+    updateGameOver();
+    m_Events.dispatch();
 }
 
-int Game::checkGameOver() {
-    if (gameOverState == 0) {
-        // The king towers should always have index 0.
-        iPlayer::EntityData northKingData = m_pNorthPlayer->getBuilding(0);
-        assert(northKingData.m_Stats.getBuildingType() == iEntityStats::King);
+void Game::buildTickGraph()
+{
+    // NOTE: These have to be added in the same order as TickPhase.
+    unsigned int phase;
+    phase = m_TickGraph.addPhase("Controllers", 1);
+    assert(phase == ControllerPhase);
+    phase = m_TickGraph.addPhase("Grids", 1);
+    assert(phase == GridPhase);
+    phase = m_TickGraph.addPhase("Targeting", ksEntitiesPerChunk);
+    assert(phase == TargetingPhase);
+    phase = m_TickGraph.addPhase("Damage", 1);
+    assert(phase == DamagePhase);
+    phase = m_TickGraph.addPhase("Integration", ksEntitiesPerChunk);
+    assert(phase == IntegrationPhase);
+    phase = m_TickGraph.addPhase("Broadphase", 1);
+    assert(phase == BroadphasePhase);
+    phase = m_TickGraph.addPhase("Resolution", ksEntitiesPerChunk);
+    assert(phase == ResolutionPhase);
+    phase = m_TickGraph.addPhase("Compaction", 1);
+    assert(phase == CompactionPhase);
+    (void)phase;    // only read by the asserts
+
+    m_TickGraph.addDependency(ControllerPhase, GridPhase);
+    m_TickGraph.addDependency(GridPhase, TargetingPhase);
 
-        iPlayer::EntityData southKingData = m_pSouthPlayer->getBuilding(0);
-        assert(southKingData.m_Stats.getBuildingType() == iEntityStats::King);
+    // Damage only touches health and pending damage, which nothing that moves
+    //  the mobs looks at.  Every mob was alive at the start of the tick (the
+    //  dead are removed at the end of each one), so the movement phases don't
+    //  need to know who's dying.
+    m_TickGraph.addDependency(TargetingPhase, DamagePhase);
+    m_TickGraph.addDependency(TargetingPhase, IntegrationPhase);
+    m_TickGraph.addDependency(IntegrationPhase, BroadphasePhase);
+    m_TickGraph.addDependency(BroadphasePhase, ResolutionPhase);
 
-        if (northKingData.m_Health <= 0)
+    m_TickGraph.addDependency(DamagePhase, CompactionPhase);
+    m_TickGraph.addDependency(ResolutionPhase, CompactionPhase);
+}
+
+void Game::runTickPhase(void* pGame, unsigned int phase, unsigned int begin, unsigned int end, unsigned int threadIndex)
+{
+    Game& game = *(Game*)pGame;
+    PROFILE_SCOPE(game.m_TickGraph.getName(phase));
+    switch (phase)
+    {
+    case ControllerPhase:   game.tickControllers(begin, end); break;
+    case GridPhase:         game.beginTick(); break;
+    case TargetingPhase:    game.tickTargeting(begin, end, threadIndex); break;
+    case DamagePhase:       game.dealDamage(threadIndex); break;
+    case IntegrationPhase:  game.integrateMobs(begin, end, threadIndex); break;
+    case BroadphasePhase:   game.rebuildBroadphaseGrid(); break;
+    case ResolutionPhase:   game.resolveCollisions(begin, end, threadIndex); break;
+    case CompactionPhase:   game.removeDead(); break;
+    default:                assert(false); break;
+    }
+}
+
+unsigned int Game::countTickPhase(void* pGame, unsigned int phase)
+{
+    Game& game = *(Game*)pGame;
+    switch (phase)
+    {
+    case ControllerPhase:
+        return 2;
+
+    case TargetingPhase:
+        return game.m_pNorthPlayer->getBuildings().size() + game.m_pNorthPlayer->getMobs().size() +
+               game.m_pSouthPlayer->getBuildings().size() + game.m_pSouthPlayer->getMobs().size();
+
+    case IntegrationPhase:
+    case ResolutionPhase:
+        return game.m_pNorthPlayer->getMobs().size() + game.m_pSouthPlayer->getMobs().size();
+
+    default:
+        // Done in one go
+        return 1;
+    }
+}
+
+void Game::tickControllers(unsigned int begin, unsigned int end)
+{
+    // NOTE: The controllers run at the same time, and read each other's mobs,
+    //  which is why Player holds on to any mobs that they place until 
+    //  beginTick() adds them.
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        getPlayer(i == 0).tick(m_TickDeltaTSec);
+    }
+}
+
+void Game::beginTick()
+{
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        pPlayer->addPlacedMobs();
+        pPlayer->getMobs().beginTick();
+    }
+
+    rebuildMobGrid();
+}
+
+void Game::tickTargeting(unsigned int begin, unsigned int end, unsigned int threadIndex)
+{
+    EntityStore* stores[] = { &m_pNorthPlayer->getBuildings(), &m_pNorthPlayer->getMobs(),
+                              &m_pSouthPlayer->getBuildings(), &m_pSouthPlayer->getMobs() };
+    const unsigned int numStores = sizeof(stores) / sizeof(stores[0]);
+
+    MatchArena& arena = m_pArenas[threadIndex];
+    forEachEntity(stores, numStores, begin, end, [&](EntityStore& store, unsigned int i)
+    {
+        if (!store.isDead(i))
         {
-            gameOverState = -1;
+            Entity(store, i).tickTargeting(m_TickDeltaTSec, arena);
         }
-        if (southKingData.m_Health <= 0)
+    });
+}
+
+void Game::dealDamage(unsigned int threadIndex)
+{
+    MatchArena& arena = m_pArenas[threadIndex];
+
+    // NOTE: This is done in a fixed order, so that the combat log comes out 
+    //  the same every time.
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        for (EntityStore* pStore : { &pPlayer->getBuildings(), &pPlayer->getMobs() })
         {
-            gameOverState = 1;
+            for (unsigned int i = 0; i < pStore->size(); ++i)
+            {
+                if (pStore->m_PendingDamage[i] > 0)
+                {
+                    Entity(*pStore, i).dealDamage(arena);
+                }
+            }
         }
     }
+}
+
+void Game::integrateMobs(unsigned int begin, unsigned int end, unsigned int threadIndex)
+{
+    EntityStore* stores[] = { &m_pNorthPlayer->getMobs(), &m_pSouthPlayer->getMobs() };
+    const unsigned int numStores = sizeof(stores) / sizeof(stores[0]);
 
-    return gameOverState;
+    MatchArena& arena = m_pArenas[threadIndex];
+    forEachEntity(stores, numStores, begin, end, [&](EntityStore& store, unsigned int i)
+    {
+        Mob(store, i).integrate(m_TickDeltaTSec, arena);
+    });
 }
 
-void Game::buildPlayers(iController* pNorthControl, iController* pSouthControl)
+void Game::rebuildBroadphaseGrid()
+{
+    if (!m_bUseMobGrid)
+    {
+        return;
+    }
+
+    // NOTE: Same order as the mob grid (see rebuildMobGrid()).
+    m_BroadphaseGrid.clear();
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        EntityStore& mobs = pPlayer->getMobs();
+        for (unsigned int i = 0; i < mobs.size(); ++i)
+        {
+            m_BroadphaseGrid.add(mobs, i, mobs.m_NextPos[i]);
+        }
+    }
+    m_BroadphaseGrid.pack();
+}
+
+void Game::resolveCollisions(unsigned int begin, unsigned int end, unsigned int threadIndex)
+{
+    EntityStore* stores[] = { &m_pNorthPlayer->getMobs(), &m_pSouthPlayer->getMobs() };
+    const unsigned int numStores = sizeof(stores) / sizeof(stores[0]);
+
+    MatchArena& arena = m_pArenas[threadIndex];
+    forEachEntity(stores, numStores, begin, end, [&](EntityStore& store, unsigned int i)
+    {
+        Mob(store, i, Mob::ResolvedPosition).resolveCollisions(m_TickDeltaTSec, arena);
+    });
+}
+
+void Game::removeDead()
+{
+    // Remove any mobs that died this tick.  Their slots are reused for new 
+    //  mobs, and anybody still targeting them will find that their handle no
+    //  longer matches (see EntityHandle).
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        pPlayer->getMobs().removeDead();
+    }
+
+    if (m_bStaticFieldsDirty)
+    {
+        buildStaticFields();
+    }
+}
+
+static const char ksSnapshotMagic[4] = { 'C', 'L', 'S', 'S' };
+
+// Which towers are standing, one bit per building.  The collision and flow 
+//  fields depend on nothing else.
+static unsigned int getStandingTowers(Player& north, Player& south)
 {
-    m_pNorthPlayer = new Player(pNorthControl, true);
-    m_pSouthPlayer = new Player(pSouthControl, false);
+    unsigned int standing = 0;
+    unsigned int bit = 0;
+    for (Player* pPlayer : { &north, &south })
+    {
+        const EntityStore& buildings = pPlayer->getBuildings();
+        for (unsigned int i = 0; i < buildings.size(); ++i, ++bit)
+        {
+            if (!buildings.isDead(i))
+                standing |= (1u << bit);
+        }
+    }
+    return standing;
 }
 
-void Game::buildWaypoints()
+void Game::saveSnapshot(Snapshot& snapshot) const
 {
-    // The first waypoint is 1 tile toward the center of the princess tower
-    const float princessSize = iEntityStats::getBuildingStats(iEntityStats::Princess).getSize();
-    const Vec2 first(PrincessLeftX + (princessSize / 2.f) + 1.f, NorthPrincessY);
-    addFourWaypoints(first);
+    SnapshotWriter writer(snapshot);
+    writer.writeBytes(ksSnapshotMagic, sizeof(ksSnapshotMagic));
+    const unsigned int version = Snapshot::ksVersion;    // write() takes a reference
+    writer.write(version);
+    writer.write(m_TickCount);
+    writer.write(gameOverState);
+    m_pNorthPlayer->save(writer);
+    m_pSouthPlayer->save(writer);
+}
 
-    for (float y = first.y + WAYPOINT_Y_INCREMENT; y < RIVER_TOP_Y; y += WAYPOINT_Y_INCREMENT)
+bool Game::restoreSnapshot(const Snapshot& snapshot)
+{
+    SnapshotReader reader(snapshot);
+    char magic[4];
+    unsigned int version;
+    if (!reader.readBytes(magic, sizeof(magic)) || (memcmp(magic, ksSnapshotMagic, sizeof(magic)) != 0) ||
+        !reader.read(version) || (version != Snapshot::ksVersion))
     {
-        addFourWaypoints(Vec2(LEFT_BRIDGE_CENTER_X, y));
+        return false;
     }
+
+    EntityStore* stores[4];
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        stores[pPlayer->getBuildings().getStoreCode()] = &pPlayer->getBuildings();
+        stores[pPlayer->getMobs().getStoreCode()] = &pPlayer->getMobs();
+    }
+
+    const unsigned int standingTowers = getStandingTowers(*m_pNorthPlayer, *m_pSouthPlayer);
+    const bool bOk = reader.read(m_TickCount) &&
+                     reader.read(gameOverState) &&
+                     m_pNorthPlayer->restore(reader, stores) &&
+                     m_pSouthPlayer->restore(reader, stores) &&
+                     reader.isAtEnd();
+    m_bGameOverPublished = false;
+
+    // Rebuilding the fields takes a while, so only do it if we have to.
+    m_bStaticFieldsDirty = false;
+    if (getStandingTowers(*m_pNorthPlayer, *m_pSouthPlayer) != standingTowers)
+    {
+        buildStaticFields();
+    }
+
+    return bOk;
 }
 
-void Game::addFourWaypoints(Vec2 pt)
+void Game::loadScenario(const Scenario& scenario)
 {
-    const float rightX = GAME_GRID_WIDTH - pt.x;
-    const float bottomY = GAME_GRID_HEIGHT - pt.y;
+    const unsigned int standingTowers = getStandingTowers(*m_pNorthPlayer, *m_pSouthPlayer);
+    m_pNorthPlayer->loadScenario(scenario);
+    m_pSouthPlayer->loadScenario(scenario);
+    reserve(scenario.getNumMobs(true) + scenario.getNumMobs(false));
+    m_TickCount = 0;
+
+    // Scenario::open() won't take one where a king is already dead.
+    gameOverState = 0;
+    m_bGameOverPublished = false;
 
-    m_Waypoints.push_back(pt);
-    m_Waypoints.push_back(Vec2(rightX, pt.y));
-    m_Waypoints.push_back(Vec2(pt.x, bottomY));
-    m_Waypoints.push_back(Vec2(rightX, bottomY));
+    m_bStaticFieldsDirty = false;
+    if (getStandingTowers(*m_pNorthPlayer, *m_pSouthPlayer) != standingTowers)
+    {
+        buildStaticFields();
+    }
+}
+
+// FNV-1a
+static unsigned long long hashBytes(unsigned long long hash, const void* pData, size_t size)
+{
+    const unsigned char* pBytes = (const unsigned char*)pData;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= pBytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+unsigned long long Game::computeStateHash() const
+{
+    // NOTE: A snapshot holds everything that the next tick depends on (the 
+    //  targets and handles included), with all of its padding zeroed, so 
+    //  that's what we hash.
+    Snapshot snapshot;
+    saveSnapshot(snapshot);
+    return hashBytes(14695981039346656037ull, snapshot.getData(), snapshot.getSize());
+}
+
+void Game::updateGameOver()
+{
+    if (gameOverState == 0)
+    {
+        const GameEvent* pEvents = m_Events.getEvents();
+        for (unsigned int i = 0; i < m_Events.getNumEvents(); ++i)
+        {
+            const GameEvent& event = pEvents[i];
+            if ((event.m_Type != GameEvent::TowerDestroyed) || 
+                (event.m_pStats->getBuildingType() != iEntityStats::King))
+                continue;
+
+            // If both kings fall in the same tick, South's counts (so North
+            //  wins).
+            if (!event.m_bNorth || (gameOverState == 0))
+                gameOverState = event.m_bNorth ? -1 : 1;
+        }
+    }
+
+    // A game that was restored or loaded already over gets announced, too.
+    if ((gameOverState != 0) && !m_bGameOverPublished)
+    {
+        m_Events.publishGameOver(gameOverState);
+        m_bGameOverPublished = true;
+    }
+}
+
+void Game::rebuildMobGrid()
+{
+    if (!m_bUseMobGrid)
+    {
+        return;
+    }
+
+    // NOTE: The north player's mobs have to go in first, followed by the 
+    //  south player's, so that the grid hands candidates back in the same 
+    //  order that the brute force loops in Mob visit them.
+    m_MobGrid.clear();
+    m_NorthTargetGrid.clear();
+    m_SouthTargetGrid.clear();
+    for (Player* pPlayer : { m_pNorthPlayer, m_pSouthPlayer })
+    {
+        EntityStore& mobs = pPlayer->getMobs();
+        SpatialGrid& targetGrid = pPlayer->isNorth() ? m_NorthTargetGrid : m_SouthTargetGrid;
+        for (unsigned int i = 0; i < mobs.size(); ++i)
+        {
+            m_MobGrid.add(mobs, i);
+            targetGrid.add(mobs, i);
+        }
+    }
+    m_MobGrid.pack();
+    m_NorthTargetGrid.pack();
+    m_SouthTargetGrid.pack();
+}
+
+void Game::buildPlayers(iController* pNorthControl, iController* pSouthControl)
+{
+    m_pNorthPlayer = new Player(*this, pNorthControl, true);
+    m_pSouthPlayer = new Player(*this, pSouthControl, false);
+    reserve(2 * ARENA_MOBS_PER_PLAYER);
+
+    for (iController* pControl : { pNorthControl, pSouthControl })
+    {
+        if (pControl)
+            m_Events.subscribe(*pControl);
+    }
+}
+
+void Game::buildStaticFields()
+{
+    PROFILE_SCOPE("buildStaticFields");
+    m_CollisionField.build(m_pNorthPlayer->getBuildings(), m_pSouthPlayer->getBuildings());
+    m_FlowField.build(m_CollisionField, m_MaxMobSize / 2.f);
+    m_bStaticFieldsDirty = false;
+}
+
+void Game::findMaxMobSize()
+{
+    m_MaxMobSize = 0.f;
+    for (int i = 0; i < iEntityStats::numMobTypes; ++i)
+    {
+        m_MaxMobSize = std::max(m_MaxMobSize, getStatRow(getStatIndex((iEntityStats::MobType)i)).m_Size);
+    }
 }
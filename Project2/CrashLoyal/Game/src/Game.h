@@ -22,42 +22,237 @@
 
 #pragma once
 
-#include "Singleton.h"
+#include "CollisionField.h"
+#include "CombatLog.h"
+#include "FlowField.h"
+#include "GameEventBus.h"
+#include "JobSystem.h"
+#include "MatchArena.h"
+#include "PerfCounters.h"
+#include "PhaseGraph.h"
+#include "Replay.h"
+#include "SpatialGrid.h"
 #include "Vec2.h"
 #include <vector>
 
 class Building;
+class Snapshot;
 class iController;
 class Mob;
 class Player;
+class Scenario;
 
-class Game : public Singleton<Game>
+// One match.  Everything in it (players, entities, controllers) gets at the
+// game through the player or store that it belongs to, rather than through 
+// anything global, so any number of games can be ticked at once on 
+// different threads.
+class Game
 {
 public:
     explicit Game();
+
+    // NOTE: we take ownership of the controllers (either may be NULL).  See 
+    //  setNumThreads() for numThreads.
+    explicit Game(iController* pNorthControl, iController* pSouthControl, unsigned int numThreads = 0);
     virtual ~Game();
 
+    // The tick is broken into phases, which run on the job system as soon as
+    //  the phases that they depend on are done:
+    //    Controllers   Each player's controller (in parallel).  Mobs that they
+    //                  place are held back until the next phase.
+    //    Grids         The new mobs are added, and the mob and target grids 
+    //                  are rebuilt.
+    //    Targeting     Every building and mob picks its target, and decides 
+    //                  whether to attack it (in parallel).
+    //    Damage        The damage is dealt, in a fixed order.  This only 
+    //                  touches health, so it runs alongside the movement 
+    //                  phases.
+    //    Integration   Every mob steers and moves (in parallel), writing to 
+    //                  EntityStore::m_NextPos while reading everyone else's 
+    //                  position from m_Pos.
+    //    Broadphase    The moved mobs go into the broadphase grid.
+    //    Resolution    Every mob that moved is pushed out of the other mobs, 
+    //                  the towers, the river and the map edges (in parallel), 
+    //                  writing its final position back to m_Pos.
+    //    Compaction    The dead are removed, and if a tower died, the 
+    //                  collision and flow fields are rebuilt.
+    //  Once the phases are done, the game is over if a king tower was 
+    //  destroyed, and everything that happened is sent to the listeners (see
+    //  getEvents()).
+    //  Nothing in a parallel phase writes to anything but its own entity (or
+    //  player), so the results don't depend on how many threads there are.  
+    //  See getTickGraph() for where the time goes.
     void tick(float deltaTSec);
 
+    // Zero means one thread per hardware thread.
+    void setNumThreads(unsigned int numThreads);
+
+    // Sizes the grids, the per-thread arenas and the event buffer for a match
+    //  with this many mobs (on both sides together), so that ticking it 
+    //  doesn't allocate.  The players' stores are sized by whoever adds the
+    //  mobs.  A new game has room for ARENA_MOBS_PER_PLAYER on each side, and
+    //  loadScenario() makes room for the scenario's mobs.
+    void reserve(unsigned int numMobs);
+    unsigned int getNumThreads() const { return m_pJobSystem->getNumThreads(); }
+
+    // The tick's phases, and how long each of them has been taking.
+    const PhaseGraph& getTickGraph() const { return m_TickGraph; }
+    PhaseGraph& getTickGraph() { return m_TickGraph; }
+
+    // What the simulation did during the last tick, and since the game was 
+    //  made (see PerfCounters).
+    const PerfCounters& getTickCounters() const { return m_TickCounters; }
+    const PerfCounters& getMatchCounters() const { return m_MatchCounters; }
+
+    // How many ticks have been run so far.
+    unsigned int getTickCount() const { return m_TickCount; }
+
+    // Attacks, deaths and so on go here.  It isn't running until somebody 
+    //  starts it.
+    CombatLog& getCombatLog() { return m_CombatLog; }
+
+    // Every mob that's placed is recorded here, while it's recording.
+    Replay& getReplay() { return m_Replay; }
+
+    // What happened during the last tick.  The controllers are subscribed 
+    //  when the game is made - anybody else who wants to hear about it can 
+    //  subscribe too.
+    GameEventBus& getEvents() { return m_Events; }
+    const GameEventBus& getEvents() const { return m_Events; }
+
+    // Saves everything that can change as the game ticks, so that 
+    //  restoreSnapshot() can put it back exactly as it was.  Only call these
+    //  between ticks.  Restoring returns false if the snapshot isn't from 
+    //  this version of the game (or is damaged, in which case the game may 
+    //  be left half restored).
+    void saveSnapshot(Snapshot& snapshot) const;
+    bool restoreSnapshot(const Snapshot& snapshot);
+
+    // Starts the match over from the scenario: its mobs and towers replace 
+    //  everything on the field, and the tick count goes back to zero.  Only
+    //  call this between ticks.  The scenario can be closed once it's loaded.
+    void loadScenario(const Scenario& scenario);
+
+    // A hash of everything that can change as the game ticks (everything 
+    //  saveSnapshot() saves), for checking that two runs (a match and its 
+    //  replay, say) went exactly the same way.
+    unsigned long long computeStateHash() const;
+
     Player& getPlayer(bool bNorth) { return bNorth ? *m_pNorthPlayer : *m_pSouthPlayer; }
+    const Player& getPlayer(bool bNorth) const { return bNorth ? *m_pNorthPlayer : *m_pSouthPlayer; }
+
+    // Negative => South won, Positive => North won, 0 => no winner yet.  
+    //  This is decided at the end of the tick that a king tower is destroyed
+    //  in (which also publishes a GameEvent::GameOver).
+    int getGameOverState() const { return gameOverState; }
+
+    // Mob vs. mob avoidance queries look in this grid, which is rebuilt at 
+    //  the start of each tick (after the controllers have placed their mobs).
+    //  If it's turned off, every mob checks every other mob instead, which 
+    //  gives the same results (it's there for A/B comparisons).
+    bool getUseMobGrid() const { return m_bUseMobGrid; }
+    void setUseMobGrid(bool bUse) { m_bUseMobGrid = bUse; }
+    const SpatialGrid& getMobGrid() const { return m_MobGrid; }
+
+    // The same, but with the mobs where they've moved to this tick, for 
+    //  resolving collisions (see Mob::resolveCollisions()).
+    const SpatialGrid& getBroadphaseGrid() const { return m_BroadphaseGrid; }
 
-    const std::vector<Vec2>& getWaypoints() const { return m_Waypoints; }
+    // Targeting looks for the closest enemy in a coarser grid that only has 
+    //  one side's mobs in it.  It's rebuilt along with the mob grid.
+    const SpatialGrid& getTargetGrid(bool bNorth) const { return bNorth ? m_NorthTargetGrid : m_SouthTargetGrid; }
 
-    int checkGameOver();
+    // The size of the largest mob type.  Grid queries are padded by this.
+    float getMaxMobSize() const { return m_MaxMobSize; }
+
+    // The map edges, the river and the towers, for mobs to collide with.
+    const CollisionField& getCollisionField() const { return m_CollisionField; }
+
+    // Mobs follow this toward their target's half of the arena.
+    const FlowField& getFlowField() const { return m_FlowField; }
+
+    // Call this when a tower is destroyed, so that mobs can walk over it.  
+    //  Other phases are still reading the fields, so they're rebuilt at the 
+    //  end of the tick.
+    void onBuildingDestroyed() { m_bStaticFieldsDirty = true; }
 
 private:
     void buildPlayers(iController* pNorthControl, iController* pSouthControl);
 
-    void buildWaypoints();
-    void addFourWaypoints(Vec2 pt);
+    // Bakes the towers into the collision and flow fields.
+    void buildStaticFields();
+
+    void findMaxMobSize();
+
+    // The tick phases (see tick()), in the order they're added to the graph
+    enum TickPhase
+    {
+        ControllerPhase,
+        GridPhase,
+        TargetingPhase,
+        DamagePhase,
+        IntegrationPhase,
+        BroadphasePhase,
+        ResolutionPhase,
+        CompactionPhase,
+
+        NumTickPhases
+    };
+
+    void buildTickGraph();
+    static void runTickPhase(void* pGame, unsigned int phase, unsigned int begin, unsigned int end, unsigned int threadIndex);
+    static unsigned int countTickPhase(void* pGame, unsigned int phase);
+
+    void tickControllers(unsigned int begin, unsigned int end);
+    void beginTick();
+    void rebuildMobGrid();
+    void tickTargeting(unsigned int begin, unsigned int end, unsigned int threadIndex);
+    void dealDamage(unsigned int threadIndex);
+    void integrateMobs(unsigned int begin, unsigned int end, unsigned int threadIndex);
+    void rebuildBroadphaseGrid();
+    void resolveCollisions(unsigned int begin, unsigned int end, unsigned int threadIndex);
+    void removeDead();
+
+    // Looks through the tick's events for a king tower being destroyed.
+    void updateGameOver();
 
 private:
     Player* m_pNorthPlayer;
     Player* m_pSouthPlayer;
 
-    std::vector<Vec2> m_Waypoints;
+    bool m_bUseMobGrid;
+    SpatialGrid m_MobGrid;
+    SpatialGrid m_NorthTargetGrid;
+    SpatialGrid m_SouthTargetGrid;
+    SpatialGrid m_BroadphaseGrid;
+    float m_MaxMobSize;
+
+    CollisionField m_CollisionField;
+    FlowField m_FlowField;
+    bool m_bStaticFieldsDirty;
+
+    // One set of scratch buffers per thread (see MatchArena)
+    JobSystem* m_pJobSystem;
+    MatchArena* m_pArenas;
+    unsigned int m_NumReservedMobs;     // see reserve()
+
+    PhaseGraph m_TickGraph;
+    float m_TickDeltaTSec;      // for the tick that's running
+    unsigned int m_TickCount;
+    PerfCounters m_TickCounters;
+    PerfCounters m_MatchCounters;
+
+    CombatLog m_CombatLog;
+    Replay m_Replay;
+    GameEventBus m_Events;
 
     // Negative => South won, Positive => North won, 0 => no winner yet
     int gameOverState; 
+    bool m_bGameOverPublished;
+
+private:
+    // DELIBERATELY UNDEFINED
+    Game(const Game& rhs);
+    Game& operator=(const Game& rhs);
 };
 
@@ -0,0 +1,128 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GameEventBus.h"
+
+#include "Entity.h"
+
+#include <algorithm>
+#include <assert.h>
+
+// Enough for a big fight, before we have to grow.
+static const unsigned int ksInitialCapacity = 1024;
+
+GameEventBus::GameEventBus()
+    : m_Tick(0)
+{
+    m_Events.reserve(ksInitialCapacity);
+}
+
+void GameEventBus::subscribe(iGameEventListener& listener)
+{
+    assert(std::find(m_Listeners.begin(), m_Listeners.end(), &listener) == m_Listeners.end());
+    m_Listeners.push_back(&listener);
+}
+
+void GameEventBus::unsubscribe(iGameEventListener& listener)
+{
+    m_Listeners.erase(std::remove(m_Listeners.begin(), m_Listeners.end(), &listener), m_Listeners.end());
+}
+
+void GameEventBus::beginTick(unsigned int tick)
+{
+    m_Events.clear();
+    m_Tick = tick;
+}
+
+GameEvent& GameEventBus::push(GameEvent::Type type, const Entity& entity)
+{
+    GameEvent event;
+    event.m_Type = type;
+    event.m_Tick = m_Tick;
+    event.m_bNorth = entity.isNorth();
+    event.m_pStats = &entity.getStats();
+    event.m_Entity = entity.getHandle();
+    event.m_bOtherNorth = false;
+    event.m_pOtherStats = NULL;
+    event.m_Value = 0;
+    m_Events.push_back(event);
+    return m_Events.back();
+}
+
+void GameEventBus::setOther(GameEvent& event, const Entity& other)
+{
+    event.m_bOtherNorth = other.isNorth();
+    event.m_pOtherStats = &other.getStats();
+    event.m_Other = other.getHandle();
+}
+
+void GameEventBus::publishSpawned(const Entity& mob)
+{
+    GameEvent& event = push(GameEvent::Spawned, mob);
+    event.m_Pos = mob.getPosition();
+}
+
+// NOTE: Damage is dealt while the mobs are moving, so we don't know where 
+//  anybody is.
+void GameEventBus::publishDamaged(const Entity& target, const Entity& attacker, int damage)
+{
+    GameEvent& event = push(GameEvent::Damaged, target);
+    setOther(event, attacker);
+    event.m_Value = damage;
+}
+
+void GameEventBus::publishDied(const Entity& target, const Entity& attacker)
+{
+    GameEvent& event = push(GameEvent::Died, target);
+    setOther(event, attacker);
+}
+
+void GameEventBus::publishTowerDestroyed(const Entity& building, const Entity& attacker)
+{
+    // Buildings don't move, so this is safe.
+    GameEvent& event = push(GameEvent::TowerDestroyed, building);
+    setOther(event, attacker);
+    event.m_Pos = building.getPosition();
+}
+
+void GameEventBus::publishGameOver(int gameOverState)
+{
+    assert(gameOverState != 0);
+
+    GameEvent event;
+    event.m_Type = GameEvent::GameOver;
+    event.m_Tick = m_Tick;
+    event.m_bNorth = (gameOverState > 0);
+    event.m_pStats = NULL;
+    event.m_bOtherNorth = false;
+    event.m_pOtherStats = NULL;
+    event.m_Value = gameOverState;
+    m_Events.push_back(event);
+}
+
+void GameEventBus::dispatch()
+{
+    for (iGameEventListener* pListener : m_Listeners)
+    {
+        pListener->onGameEvents(m_Events.data(), (unsigned int)m_Events.size());
+    }
+}
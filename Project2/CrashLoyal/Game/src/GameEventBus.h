@@ -0,0 +1,82 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "iGameEventListener.h"
+
+#include <vector>
+
+class Entity;
+
+// Everything that happened during the tick that's running (or that ran last),
+// for anybody who wants to know without looking through every entity.  The 
+// tick publishes into it as things happen, and once the tick is over, Game 
+// hands the whole buffer to each of the listeners in turn.
+//
+// NOTE: Only the Grids and Damage phases publish, and they never run at the
+// same time as each other, so publishing is just a push_back.  The buffer is
+// emptied at the start of each tick (keeping its capacity), so it stops 
+// allocating once it's grown to fit the busiest tick.
+class GameEventBus
+{
+public:
+    GameEventBus();
+
+    // Makes room for this many events in a tick.
+    void reserve(unsigned int numEvents) { m_Events.reserve(numEvents); }
+
+    // Listeners are NOT owned, and must stay around until they unsubscribe
+    //  (or the game is deleted).
+    void subscribe(iGameEventListener& listener);
+    void unsubscribe(iGameEventListener& listener);
+
+    // Empties the buffer, and stamps everything that's published from now on
+    //  with tick.
+    void beginTick(unsigned int tick);
+
+    void publishSpawned(const Entity& mob);
+    void publishDamaged(const Entity& target, const Entity& attacker, int damage);
+    void publishDied(const Entity& target, const Entity& attacker);
+    void publishTowerDestroyed(const Entity& building, const Entity& attacker);
+    void publishGameOver(int gameOverState);
+
+    // Hands the buffer to every listener.
+    void dispatch();
+
+    const GameEvent* getEvents() const { return m_Events.data(); }
+    unsigned int getNumEvents() const { return (unsigned int)m_Events.size(); }
+
+private:
+    GameEvent& push(GameEvent::Type type, const Entity& entity);
+    static void setOther(GameEvent& event, const Entity& other);
+
+private:
+    std::vector<GameEvent> m_Events;
+    std::vector<iGameEventListener*> m_Listeners;
+    unsigned int m_Tick;
+
+private:
+    // DELIBERATELY UNDEFINED
+    GameEventBus(const GameEventBus& rhs);
+    GameEventBus& operator=(const GameEventBus& rhs);
+};
@@ -1,11 +1,51 @@
 #include "Graphics.h"
 
 #include "Constants.h"
+#include "Profiler.h"
 #include <algorithm>
+#include <cstdio>
+#include <ctype.h>
 
 Graphics* Singleton<Graphics>::s_Obj = NULL;
 
-Graphics::Graphics() {
+// A 3x5 pixel font, for the UI panel, covering ' ' to 'Z' (lower case is drawn 
+//  as upper case).  Each glyph is its five rows, top first, three bits each,
+//  with the left pixel in the highest bit.
+static const int ksFontWidth = 3;
+static const int ksFontHeight = 5;
+static const unsigned short ksFontGlyphs['Z' - ' ' + 1] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x01C0, 0x0002, 0x12A4,
+    0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249,
+    0x7BEF, 0x7BCF, 0x0410, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B,
+    0x5BED, 0x7497, 0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A,
+    0x6BA4, 0x2B73, 0x6BAD, 0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD,
+    0x5AAD, 0x5A92, 0x72A7,
+};
+
+FrameStats::FrameStats()
+	: m_FrameMs(0.f)
+	, m_SimMs(0.f)
+	, m_RenderMs(0.f)
+	, m_BudgetMs(0.f)
+	, m_NumTicks(0)
+	, m_NumCollisionPairs(0)
+	, m_NumTargetScans(0)
+	, m_NumHeapAllocs(0)
+{
+	m_NumMobs[0] = m_NumMobs[1] = 0;
+}
+
+Graphics::Graphics()
+	: m_GameOverState(0)
+	, m_FrameHistoryNext(0)
+	, m_NumBatchDraws(0)
+	, m_LastBatchDraws(0)
+{
+	std::fill(m_FrameHistory, m_FrameHistory + ksFrameHistory, 0.f);
+	m_Rects.reserve(1024);
+
 	gWindow = SDL_CreateWindow("Crash Loyal", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, SDL_WINDOW_SHOWN);
 	if (gWindow == NULL) {
 		gRenderer = NULL;
@@ -13,7 +53,7 @@ Graphics::Graphics() {
 	}
 	else {
 		//Create renderer for window
-		gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
+		gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 		if (gRenderer == NULL) {
 			printf("Renderer could not be created! SDL Error: %s\n", SDL_GetError());
 		}
@@ -45,70 +85,87 @@ Graphics::~Graphics() {
 }
 
 void Graphics::render() {
+    flushBatches();
+
+    PROFILE_SCOPE("Present");
     SDL_RenderPresent(gRenderer);
 }
 
 void Graphics::resetFrame() {
+    m_LastBatchDraws = m_NumBatchDraws;
+    m_NumBatchDraws = 0;
+
     drawBG();
     drawUI();
 }
 
-void Graphics::drawMob(Entity* m) {
-	int alpha = healthToAlpha(m);
-
-	if (m->isNorth())
-		SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, alpha);
-	else
-		SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, alpha);
-
-	float centerX = m->getPosition().x * PIXELS_PER_METER;
-	float centerY = m->getPosition().y * PIXELS_PER_METER;
-	float squareSize = m->getStats().getSize() * PIXELS_PER_METER;
-
-	drawSquare(centerX, centerY, squareSize);
+void Graphics::drawMob(const Entity& m) {
+	float centerX = m.getPosition().x * PIXELS_PER_METER;
+	float centerY = m.getPosition().y * PIXELS_PER_METER;
+	float squareSize = m.getStatRow().m_Size * PIXELS_PER_METER;
 
-	SDL_Rect stringRect = {
-		(int)(centerX - (squareSize / 2.f)),
-		(int)(centerY - (squareSize / 2.f)),
-		(int)squareSize,
-		(int)squareSize
-	};
-	SDL_Color stringColor = { 0, 0, 0, 255 };
-	drawText(m->getStats().getDisplayLetter(), stringRect, stringColor);
+	// NOTE: drawText() doesn't draw anything yet, so there's no letter on 
+	//  the square.  When it does, the letters will want batching too.
+	addToBatch(m.isNorth() ? NorthBatch : SouthBatch, healthToAlpha(m), getSquare(centerX, centerY, squareSize));
 }
 
 
-void Graphics::drawSquare(float centerX, float centerY, float size) {
-    // Draws a square at the given pixel coordinate
+SDL_Rect Graphics::getSquare(float centerX, float centerY, float size) {
     SDL_Rect rect = {
         (int)(centerX - (size / 2.f)),
         (int)(centerY - (size / 2.f)),
         (int)(size),
         (int)(size)
     };
-    SDL_RenderFillRect(gRenderer, &rect);
+    return rect;
 }
 
-int Graphics::healthToAlpha(const Entity* e)
+int Graphics::healthToAlpha(const Entity& e)
 {
-    float health = std::max(0.f, (float)e->getHealth());
-    float maxHealth = (float)e->getStats().getMaxHealth();
+    float health = std::max(0.f, (float)e.getHealth());
+    float maxHealth = (float)e.getStatRow().m_MaxHealth;
     return (int)(((health / maxHealth) * 200.f) + 55.f);
 }
 
-void Graphics::drawBuilding(Entity* b) {
-    int alpha = healthToAlpha(b);
+void Graphics::addToBatch(BatchColor color, int alpha, const SDL_Rect& rect) {
+    alpha = std::min(std::max(alpha, 0), (int)ksNumAlphas - 1);
+    m_Batches[color][alpha].push_back(rect);
+}
 
-    if (b->isDead())
-        SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0x00, 100);
-    else if (b->isNorth())
-        SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x00, 0x00, alpha);
-    else
-        SDL_SetRenderDrawColor(gRenderer, 0x00, 0x00, 0xFF, alpha);
+void Graphics::flushBatches() {
+    static const SDL_Color ksBatchColors[NumBatchColors] = {
+        { 0xFF, 0x00, 0x00, 0xFF },     // NorthBatch
+        { 0x00, 0x00, 0xFF, 0xFF },     // SouthBatch
+        { 0x00, 0x00, 0x00, 0xFF },     // DeadBatch
+    };
 
-    drawSquare(b->getPosition().x * PIXELS_PER_METER,
-        b->getPosition().y * PIXELS_PER_METER,
-        b->getStats().getSize() * PIXELS_PER_METER);
+    // NOTE: The colors are drawn in order, so South's mobs still go on top of
+    //  North's.  Only squares of the same color, which used to be drawn in 
+    //  the order the mobs are stored, now go in order of alpha.
+    for (int color = 0; color < NumBatchColors; ++color) {
+        for (unsigned int alpha = 0; alpha < ksNumAlphas; ++alpha) {
+            std::vector<SDL_Rect>& batch = m_Batches[color][alpha];
+            if (batch.empty())
+                continue;
+
+            const SDL_Color& c = ksBatchColors[color];
+            SDL_SetRenderDrawColor(gRenderer, c.r, c.g, c.b, (Uint8)alpha);
+            SDL_RenderFillRects(gRenderer, batch.data(), (int)batch.size());
+            batch.clear();
+            ++m_NumBatchDraws;
+        }
+    }
+}
+
+void Graphics::drawBuilding(const Entity& b) {
+    const SDL_Rect square = getSquare(b.getPosition().x * PIXELS_PER_METER,
+        b.getPosition().y * PIXELS_PER_METER,
+        b.getStatRow().m_Size * PIXELS_PER_METER);
+
+    if (b.isDead())
+        addToBatch(DeadBatch, 100, square);
+    else
+        addToBatch(b.isNorth() ? NorthBatch : SouthBatch, healthToAlpha(b), square);
 }
 
 void Graphics::drawText(const char* textToDraw, SDL_Rect messageRect, SDL_Color color) {
@@ -153,6 +210,7 @@ void Graphics::drawGrid() {
 }
 
 void Graphics::drawBG() {
+    PROFILE_SCOPE("drawBG");
     SDL_Rect bgRect = {
         0,
         0,
@@ -196,10 +254,18 @@ void Graphics::drawBG() {
     drawGrid();
 }
 
-void Graphics::drawWinScreen(int winningSide) {
-    if (winningSide == 0) { return; }
+void Graphics::onGameEvents(const GameEvent* pEvents, unsigned int numEvents) {
+	for (unsigned int i = 0; i < numEvents; ++i) {
+		if (pEvents[i].m_Type == GameEvent::GameOver) {
+			m_GameOverState = pEvents[i].m_Value;
+		}
+	}
+}
+
+void Graphics::drawWinScreen() {
+    if (m_GameOverState == 0) { return; }
 
-    const char* msg = (winningSide > 0) ? "Game Over. North Wins!" : "Game Over. South Wins!";
+    const char* msg = (m_GameOverState > 0) ? "Game Over. North Wins!" : "Game Over. South Wins!";
     int topY = SCREEN_HEIGHT_PIXELS / 5;
     int leftX = SCREEN_WIDTH_PIXELS / 15;
     int height = SCREEN_HEIGHT_PIXELS / 3;
@@ -211,6 +277,7 @@ void Graphics::drawWinScreen(int winningSide) {
 }
 
 void Graphics::drawUI() {
+    PROFILE_SCOPE("drawUI");
     // Draws the rectangle to the right of the play area that contains the UI
 
     SDL_Rect uiRect = {
@@ -222,5 +289,117 @@ void Graphics::drawUI() {
     SDL_SetRenderDrawColor(gRenderer, 0x50, 0x50, 0x50, 100);
     SDL_RenderFillRect(gRenderer, &uiRect);
 
+    // The live numbers, one per line
+    const int scale = 3;
+    const int left = uiRect.x + 10;
+    const int lineHeight = (ksFontHeight + 3) * scale;
+    const int valueX = left + (12 * (ksFontWidth + 1) * scale);
+    int y = 10;
+
+    struct StatLine
+    {
+        const char* m_pLabel;
+        float m_Value;
+        int m_Decimals;
+    };
+    const StatLine lines[] = {
+        { "SIM MS", m_FrameStats.m_SimMs, 2 },
+        { "DRAW MS", m_FrameStats.m_RenderMs, 2 },
+        { "FRAME MS", m_FrameStats.m_FrameMs, 1 },
+        { "TICKS", (float)m_FrameStats.m_NumTicks, 0 },
+        { "NORTH MOBS", (float)m_FrameStats.m_NumMobs[0], 0 },
+        { "SOUTH MOBS", (float)m_FrameStats.m_NumMobs[1], 0 },
+        { "PAIRS/TICK", (float)m_FrameStats.m_NumCollisionPairs, 0 },
+        { "SCANS/TICK", (float)m_FrameStats.m_NumTargetScans, 0 },
+        { "ALLOCS/TICK", (float)m_FrameStats.m_NumHeapAllocs, 0 },
+        { "BATCH DRAWS", (float)m_LastBatchDraws, 0 },
+    };
+
+    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+    char value[32];
+    for (const StatLine& line : lines) {
+        snprintf(value, sizeof(value), "%.*f", line.m_Decimals, line.m_Value);
+        drawString(line.m_pLabel, left, y, scale);
+        drawString(value, valueX, y, scale);
+        y += lineHeight;
+    }
+
+    // And how long the last few seconds' worth of frames took
+    y += lineHeight;
+    drawString("FRAME TIME", left, y, scale);
+    y += lineHeight;
+
+    const SDL_Rect graphRect = { left, y, (int)ksFrameHistory * 2, 150 };
+    drawFrameGraph(graphRect);
+}
+
+void Graphics::setFrameStats(const FrameStats& stats) {
+    m_FrameStats = stats;
+    m_FrameHistory[m_FrameHistoryNext] = stats.m_FrameMs;
+    m_FrameHistoryNext = (m_FrameHistoryNext + 1) % ksFrameHistory;
+}
+
+int Graphics::drawString(const char* pText, int x, int y, int scale) {
+    // Every lit pixel is a rectangle, and they all go in one call.
+    m_Rects.clear();
+    int penX = x;
+    for (const char* p = pText; *p; ++p) {
+        const int c = toupper((unsigned char)*p);
+        const unsigned short glyph = ((c >= ' ') && (c <= 'Z')) ? ksFontGlyphs[c - ' '] : 0;
+        for (int row = 0; row < ksFontHeight; ++row) {
+            for (int col = 0; col < ksFontWidth; ++col) {
+                const int bit = ((ksFontHeight - 1 - row) * ksFontWidth) + (ksFontWidth - 1 - col);
+                if (glyph & (1 << bit)) {
+                    SDL_Rect rect = { penX + (col * scale), y + (row * scale), scale, scale };
+                    m_Rects.push_back(rect);
+                }
+            }
+        }
+        penX += (ksFontWidth + 1) * scale;
+    }
+
+    if (!m_Rects.empty()) {
+        SDL_RenderFillRects(gRenderer, m_Rects.data(), (int)m_Rects.size());
+    }
+    return penX - x;
+}
+
+void Graphics::drawFrameGraph(const SDL_Rect& area) {
+    SDL_SetRenderDrawColor(gRenderer, 0x20, 0x20, 0x20, 0xFF);
+    SDL_RenderFillRect(gRenderer, &area);
+
+    // The top of the graph is twice the budget, and anything over the budget
+    //  is drawn in red.
+    const float budgetMs = std::max(0.001f, m_FrameStats.m_BudgetMs);
+    const float pixelsPerMs = (float)area.h / (2.f * budgetMs);
+    const int barWidth = area.w / (int)ksFrameHistory;
+    const int bottom = area.y + area.h;
+
+    for (int bOver = 0; bOver < 2; ++bOver) {
+        m_Rects.clear();
+        for (unsigned int i = 0; i < ksFrameHistory; ++i) {
+            const float ms = m_FrameHistory[(m_FrameHistoryNext + i) % ksFrameHistory];
+            if ((ms > budgetMs) != (bOver != 0)) {
+                continue;
+            }
+
+            const int height = std::min(area.h, (int)(ms * pixelsPerMs));
+            SDL_Rect bar = { area.x + ((int)i * barWidth), bottom - height, barWidth, height };
+            m_Rects.push_back(bar);
+        }
+
+        if (bOver) {
+            SDL_SetRenderDrawColor(gRenderer, 0xFF, 0x40, 0x40, 0xFF);
+        }
+        else {
+            SDL_SetRenderDrawColor(gRenderer, 0x40, 0xFF, 0x40, 0xFF);
+        }
+        if (!m_Rects.empty()) {
+            SDL_RenderFillRects(gRenderer, m_Rects.data(), (int)m_Rects.size());
+        }
+    }
 
+    // The budget line, half way up
+    SDL_SetRenderDrawColor(gRenderer, 0xFF, 0xFF, 0x00, 0xFF);
+    SDL_RenderDrawLine(gRenderer, area.x, bottom - (area.h / 2), area.x + area.w, bottom - (area.h / 2));
 }
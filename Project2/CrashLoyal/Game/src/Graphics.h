@@ -1,12 +1,32 @@
 #pragma once
 
 #include "Entity.h"
+#include "iGameEventListener.h"
 #include "SDL.h"
 #include "SDL_image.h"
 // #include "SDL_ttf.h"
 #include "Singleton.h"
 
-class Graphics : public Singleton<Graphics> {
+#include <vector>
+
+// What the UI panel shows (see Graphics::drawUI()).  The main loop fills it 
+// in once a frame, from counters that the game keeps as it ticks.
+struct FrameStats
+{
+	FrameStats();
+
+	float m_FrameMs;					// from the start of the last frame to this one
+	float m_SimMs;						// ticking the game, this frame
+	float m_RenderMs;					// drawing the last frame
+	float m_BudgetMs;					// one simulation step
+	unsigned int m_NumTicks;			// this frame
+	unsigned int m_NumMobs[2];			// North, South
+	unsigned int m_NumCollisionPairs;	// during the last tick
+	unsigned int m_NumTargetScans;		// during the last tick
+	unsigned int m_NumHeapAllocs;		// per tick, this frame
+};
+
+class Graphics : public Singleton<Graphics>, public iGameEventListener {
 	/**
 	 * Houses the logic for drawing the game to the screen.
 	 * Acts as a StringBuilder but for images drawn the the canvas.
@@ -16,26 +36,77 @@ public:
 	Graphics();
 	virtual ~Graphics();  //SDL_DestroyRenderer(gRenderer);
 
-	void drawMob(Entity* m);
+	// NOTE: Mobs and buildings aren't drawn right away.  Their squares are 
+	// gathered up by color and alpha, and flushBatches() draws each 
+	// combination in one call, so the number of draw calls doesn't grow 
+	// with the number of mobs.
+	void drawMob(const Entity& m);
 	void drawText(const char* textToDraw, SDL_Rect messageRect, SDL_Color color);
-	void drawBuilding(Entity* b);
+	void drawBuilding(const Entity& b);
+
+	// Draws everything that's been batched up since the last flush, on top
+	//  of whatever has been drawn already.  render() flushes, too.
+	void flushBatches();
 
 	void resetFrame();
 
-	void drawWinScreen(int winningSide);
+	// Draws the winner, once we've heard that the game is over.
+	void drawWinScreen();
+
+	// Subscribe to the game's events, so that we know when it's over.
+	void onGameEvents(const GameEvent* pEvents, unsigned int numEvents);
+
+	// For the UI panel, which is drawn by the next resetFrame().
+	void setFrameStats(const FrameStats& stats);
 
 	void render();
 
 private: 
 
-	void drawSquare(float centerX, float centerY, float size);
-	int healthToAlpha(const Entity* e);
+	// The colors that the mobs and buildings are drawn in
+	enum BatchColor
+	{
+		NorthBatch,
+		SouthBatch,
+		DeadBatch,
+
+		NumBatchColors
+	};
+
+	// A square centered on the given pixel coordinate
+	SDL_Rect getSquare(float centerX, float centerY, float size);
+	int healthToAlpha(const Entity& e);
+	void addToBatch(BatchColor color, int alpha, const SDL_Rect& rect);
 
 	void drawGrid();
 	void drawBG();
 	void drawUI();
 
+	// Draws text in the built in pixel font (see ksFontGlyphs), with the top 
+	//  left corner at (x, y).  Each of the font's pixels is scale pixels 
+	//  square.  Returns the width of what was drawn.
+	int drawString(const char* pText, int x, int y, int scale);
+
+	// The frame times, oldest first, as bars against the budget.
+	void drawFrameGraph(const SDL_Rect& area);
+
 	SDL_Renderer* gRenderer;
 	SDL_Window* gWindow;
+
+	int m_GameOverState;	// see Game::getGameOverState()
+
+	FrameStats m_FrameStats;
+	static const unsigned int ksFrameHistory = 140;
+	float m_FrameHistory[ksFrameHistory];	// in ms, a ring of the latest frames
+	unsigned int m_FrameHistoryNext;
+	std::vector<SDL_Rect> m_Rects;			// to batch up rectangles in
+
+	// One batch for every alpha that each color can be drawn with.  The 
+	//  batches keep their capacity, so they stop allocating once they've 
+	//  grown to fit the biggest fight.
+	static const unsigned int ksNumAlphas = 256;
+	std::vector<SDL_Rect> m_Batches[NumBatchColors][ksNumAlphas];
+	unsigned int m_NumBatchDraws;			// this frame
+	unsigned int m_LastBatchDraws;			// the last frame, for the UI panel
 // 	TTF_Font* sans;
 };
\ No newline at end of file
@@ -0,0 +1,188 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Headless.h"
+
+#include "Constants.h"
+#include "Game.h"
+#include "Player.h"
+#include "Replay.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Count every heap allocation, so that we can see whether a warmed up match
+//  still allocates as it ticks (the UI panel shows it live, too).  SDL 
+//  allocates with malloc, so this only counts our own allocations.
+static std::atomic<unsigned long long> s_NumHeapAllocs(0);
+
+void* operator new(size_t size)
+{
+    ++s_NumHeapAllocs;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+unsigned long long getNumHeapAllocs()
+{
+    return s_NumHeapAllocs;
+}
+
+HeadlessConfig::HeadlessConfig()
+    : m_MaxTicks(36000)         // 30 minutes of game time at SIM_HZ
+    , m_WarmupTicks(600)        // 30 seconds
+    , m_DeltaTSec(1.f / SIM_HZ)
+    , m_bReportPhases(false)
+    , m_pRecordPath(NULL)
+{
+}
+
+int runHeadless(Game& game, const HeadlessConfig& config)
+{
+    using namespace std::chrono;
+
+    unsigned int numTicks = 0;
+    int gameOverState = 0;
+
+    const unsigned long long startAllocs = s_NumHeapAllocs;
+    unsigned long long warmupAllocs = 0;
+
+    if (config.m_pRecordPath)
+    {
+        game.getReplay().startRecording(config.m_DeltaTSec);
+    }
+
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+    while ((numTicks < config.m_MaxTicks) && (gameOverState == 0))
+    {
+        game.tick(config.m_DeltaTSec);
+        gameOverState = game.getGameOverState();
+        ++numTicks;
+
+        if (numTicks == config.m_WarmupTicks)
+        {
+            warmupAllocs = s_NumHeapAllocs - startAllocs;
+
+            // Leave the warmup out of the phase timings, too.
+            game.getTickGraph().resetTotals();
+        }
+    }
+    high_resolution_clock::time_point endTime = high_resolution_clock::now();
+
+    if (config.m_pRecordPath)
+    {
+        Replay& replay = game.getReplay();
+        replay.stopRecording(numTicks, game.computeStateHash());
+        if (!replay.save(config.m_pRecordPath))
+        {
+            std::cout << "Couldn't save the replay to " << config.m_pRecordPath << std::endl;
+        }
+    }
+
+    // Let the log finish writing before we print anything ourselves.
+    CombatLog& log = game.getCombatLog();
+    const bool bLogging = log.isRunning();
+    log.stop();
+
+    const double wallSec = duration_cast<duration<double>>(endTime - startTime).count();
+    const double ticksPerSec = (wallSec > 0.0) ? ((double)numTicks / wallSec) : 0.0;
+
+    std::cout << "Headless match finished: ";
+    if (gameOverState > 0)
+        std::cout << "North wins";
+    else if (gameOverState < 0)
+        std::cout << "South wins";
+    else
+        std::cout << "no winner";
+    std::cout << std::endl;
+
+    std::cout << "  Ticks:          " << numTicks << std::endl;
+    std::cout << "  Game time:      " << (numTicks * config.m_DeltaTSec) << " sec" << std::endl;
+    std::cout << "  Wall time:      " << wallSec << " sec" << std::endl;
+    std::cout << "  Ticks per sec:  " << ticksPerSec << std::endl;
+    std::cout << "  Mobs remaining: " << game.getPlayer(true).getNumMobs() << " North, "
+        << game.getPlayer(false).getNumMobs() << " South" << std::endl;
+    if (bLogging)
+    {
+        std::cout << "  Combat events:  " << log.getNumWritten() << " written, "
+            << log.getNumDropped() << " dropped" << std::endl;
+    }
+    if (numTicks > config.m_WarmupTicks)
+    {
+        std::cout << "  Heap allocs:    " << warmupAllocs << " in the first " << config.m_WarmupTicks
+            << " ticks, " << (s_NumHeapAllocs - startAllocs - warmupAllocs) << " after" << std::endl;
+    }
+
+    std::cout << "  Perf counters:" << std::endl;
+    game.getMatchCounters().write(std::cout);
+
+    if (config.m_bReportPhases)
+    {
+        game.getTickGraph().writeReport(std::cout);
+    }
+
+    return gameOverState;
+}
+
+bool runReplay(Game& game, const Replay& replay)
+{
+    using namespace std::chrono;
+
+    high_resolution_clock::time_point startTime = high_resolution_clock::now();
+    while (game.getTickCount() < replay.getNumTicks())
+    {
+        game.tick(replay.getDeltaTSec());
+    }
+    high_resolution_clock::time_point endTime = high_resolution_clock::now();
+
+    game.getCombatLog().stop();
+
+    const double wallSec = duration_cast<duration<double>>(endTime - startTime).count();
+    const unsigned long long stateHash = game.computeStateHash();
+    const bool bMatched = (stateHash == replay.getStateHash());
+
+    std::cout << "Replay " << (bMatched ? "matched" : "DIVERGED") << std::endl;
+    std::cout << "  Ticks:          " << replay.getNumTicks() << std::endl;
+    std::cout << "  Game time:      " << (replay.getNumTicks() * replay.getDeltaTSec()) << " sec" << std::endl;
+    std::cout << "  Wall time:      " << wallSec << " sec" << std::endl;
+    std::cout << "  Placements:     " << replay.getInputs(true).size() << " North, " 
+        << replay.getInputs(false).size() << " South" << std::endl;
+    std::cout << std::hex << "  State hash:     " << stateHash << " (recorded " 
+        << replay.getStateHash() << ")" << std::dec << std::endl;
+
+    return bMatched;
+}
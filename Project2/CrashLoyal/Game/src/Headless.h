@@ -0,0 +1,54 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Runs a match with no window, renderer or event pump.  Game::tick() is called 
+// back to back as fast as the CPU allows, using a fixed amount of game time 
+// per tick, and the achieved tick rate is reported when the match ends.  This 
+// needs nothing from SDL, so it works on machines without a display.
+
+struct HeadlessConfig
+{
+    HeadlessConfig();
+
+    unsigned int m_MaxTicks;    // give up after this many ticks if nobody has won
+    unsigned int m_WarmupTicks; // heap allocations after this many ticks are reported separately
+    float m_DeltaTSec;          // game time that passes on each tick
+    bool m_bReportPhases;       // print where the tick's time went (see PhaseGraph)
+    const char* m_pRecordPath;  // if not NULL, save a replay of the match here
+};
+
+class Game;
+class Replay;
+
+// How many times the heap has been allocated from (with new), by any thread.
+unsigned long long getNumHeapAllocs();
+
+// Ticks the game until it's over (or we run out of ticks), then prints the 
+// results.  Returns the game over state (see Game::getGameOverState()).
+int runHeadless(Game& game, const HeadlessConfig& config);
+
+// Ticks the game, whose controllers should be playing the replay back (see
+// ReplayController), for as long as the recorded match went on, and then 
+// checks that it ended up in the same state.  Returns true if it did.
+bool runReplay(Game& game, const Replay& replay);
@@ -0,0 +1,322 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <assert.h>
+
+// How many times an idle thread looks for work before it goes to sleep.  
+//  Phases are short, so the next one is usually ready before it's worth 
+//  paying to go to sleep and be woken up again.
+static const unsigned int ksSpinsBeforeWaiting = 64;
+
+bool JobSystem::JobQueue::push(const Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Count == ksCapacity)
+    {
+        return false;
+    }
+
+    m_Jobs[(m_Head + m_Count) % ksCapacity] = job;
+    ++m_Count;
+    return true;
+}
+
+bool JobSystem::JobQueue::popBack(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Count == 0)
+    {
+        return false;
+    }
+
+    --m_Count;
+    job = m_Jobs[(m_Head + m_Count) % ksCapacity];
+    return true;
+}
+
+bool JobSystem::JobQueue::popFront(Job& job)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Count == 0)
+    {
+        return false;
+    }
+
+    job = m_Jobs[m_Head];
+    m_Head = (m_Head + 1) % ksCapacity;
+    --m_Count;
+    return true;
+}
+
+JobSystem::JobSystem(unsigned int numThreads)
+    : m_NumThreads(numThreads)
+    , m_pQueues(NULL)
+    , m_SignalCount(0)
+    , m_NumWaiting(0)
+    , m_bQuit(false)
+    , m_pGraph(NULL)
+    , m_PhasesLeft(0)
+{
+    if (m_NumThreads == 0)
+    {
+        m_NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_pQueues = new JobQueue[m_NumThreads];
+
+    // The calling thread is one of them.
+    m_Threads.reserve(m_NumThreads - 1);
+    for (unsigned int i = 1; i < m_NumThreads; ++i)
+    {
+        m_Threads.push_back(std::thread(&JobSystem::workerMain, this, i));
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bQuit = true;
+        ++m_SignalCount;
+    }
+    m_Signal.notify_all();
+
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+
+    delete[] m_pQueues;
+}
+
+void JobSystem::run(PhaseGraph& graph)
+{
+    m_pGraph = &graph;
+    m_RunStart = std::chrono::steady_clock::now();
+    graph.beginRun();
+    m_PhasesLeft = graph.m_NumPhases;
+
+    for (unsigned int i = 0; i < graph.m_NumPhases; ++i)
+    {
+        if (graph.m_Phases[i].m_NumDependencies == 0)
+        {
+            makeReady(i, 0);
+        }
+    }
+
+    unsigned int numSpins = 0;
+    while (m_PhasesLeft > 0)
+    {
+        const unsigned int signalCount = m_SignalCount;
+
+        Job job;
+        if (getJob(0, job))
+        {
+            doJob(0, job);
+            numSpins = 0;
+        }
+        else if (++numSpins < ksSpinsBeforeWaiting)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            waitForSignal(signalCount, true);
+        }
+    }
+
+    graph.endRun(getTimeNs());
+}
+
+void JobSystem::workerMain(unsigned int threadIndex)
+{
+    unsigned int numSpins = 0;
+    for (;;)
+    {
+        const unsigned int signalCount = m_SignalCount;
+
+        Job job;
+        if (getJob(threadIndex, job))
+        {
+            doJob(threadIndex, job);
+            numSpins = 0;
+        }
+        else if (++numSpins < ksSpinsBeforeWaiting)
+        {
+            std::this_thread::yield();
+        }
+        else if (!waitForSignal(signalCount, false))
+        {
+            return;
+        }
+    }
+}
+
+bool JobSystem::getJob(unsigned int threadIndex, Job& job)
+{
+    if (m_pQueues[threadIndex].popBack(job))
+    {
+        return true;
+    }
+
+    for (unsigned int i = 1; i < m_NumThreads; ++i)
+    {
+        if (m_pQueues[(threadIndex + i) % m_NumThreads].popFront(job))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::doJob(unsigned int threadIndex, Job job)
+{
+    PhaseGraph& graph = *m_pGraph;
+    PhaseGraph::Phase& phase = graph.m_Phases[job.m_Phase];
+
+    // Leave the back half for somebody else (or for us, later on), until 
+    //  what's left is no bigger than the grain.
+    if (m_NumThreads > 1)
+    {
+        while ((job.m_End - job.m_Begin) > phase.m_Grain)
+        {
+            const unsigned int numChunks = ((job.m_End - job.m_Begin) + phase.m_Grain - 1) / phase.m_Grain;
+            const unsigned int mid = job.m_Begin + ((numChunks / 2) * phase.m_Grain);
+
+            Job backHalf = { job.m_Phase, mid, job.m_End };
+            if (!m_pQueues[threadIndex].push(backHalf))
+            {
+                break;
+            }
+            signal();
+            job.m_End = mid;
+        }
+    }
+
+    const long long startNs = getTimeNs();
+    long long noStart = -1;
+    phase.m_StartNs.compare_exchange_strong(noStart, startNs);
+
+    graph.m_pRangeFunc(graph.m_pContext, job.m_Phase, job.m_Begin, job.m_End, threadIndex);
+
+    // NOTE: Once the last of the phase's items are counted off, the run can 
+    //  end at any moment, so everything else has to be recorded first.
+    phase.m_BusyNs += getTimeNs() - startNs;
+    ++phase.m_NumJobs;
+
+    const unsigned int numItems = job.m_End - job.m_Begin;
+    if (phase.m_ItemsLeft.fetch_sub(numItems) == numItems)
+    {
+        finishPhase(job.m_Phase, threadIndex);
+    }
+}
+
+void JobSystem::pushJob(unsigned int threadIndex, const Job& job)
+{
+    if (m_pQueues[threadIndex].push(job))
+    {
+        signal();
+    }
+    else
+    {
+        doJob(threadIndex, job);
+    }
+}
+
+void JobSystem::makeReady(unsigned int phaseIndex, unsigned int threadIndex)
+{
+    PhaseGraph& graph = *m_pGraph;
+    PhaseGraph::Phase& phase = graph.m_Phases[phaseIndex];
+
+    phase.m_ReadyNs = getTimeNs();
+    phase.m_NumItems = graph.m_pCountFunc(graph.m_pContext, phaseIndex);
+    if (phase.m_NumItems == 0)
+    {
+        finishPhase(phaseIndex, threadIndex);
+        return;
+    }
+
+    phase.m_ItemsLeft = phase.m_NumItems;
+    Job job = { phaseIndex, 0, phase.m_NumItems };
+    pushJob(threadIndex, job);
+}
+
+void JobSystem::finishPhase(unsigned int phaseIndex, unsigned int threadIndex)
+{
+    PhaseGraph& graph = *m_pGraph;
+    PhaseGraph::Phase& phase = graph.m_Phases[phaseIndex];
+    phase.m_EndNs = getTimeNs();
+
+    for (unsigned int i = 0; i < phase.m_NumDependents; ++i)
+    {
+        const unsigned int dependent = phase.m_Dependents[i];
+        if (graph.m_Phases[dependent].m_DependenciesLeft.fetch_sub(1) == 1)
+        {
+            makeReady(dependent, threadIndex);
+        }
+    }
+
+    if (m_PhasesLeft.fetch_sub(1) == 1)
+    {
+        signal();
+    }
+}
+
+void JobSystem::signal()
+{
+    ++m_SignalCount;
+
+    // NOTE: Anybody who's about to wait bumps m_NumWaiting before they check
+    //  m_SignalCount, and we bump m_SignalCount before we check m_NumWaiting,
+    //  so either they see the new count or we see them.  If we see them, 
+    //  taking the lock makes sure that they're actually waiting before we 
+    //  notify them.
+    if (m_NumWaiting > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+        }
+        m_Signal.notify_all();
+    }
+}
+
+bool JobSystem::waitForSignal(unsigned int signalCount, bool bForRun)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    ++m_NumWaiting;
+    if (!m_bQuit && (m_SignalCount == signalCount) && !(bForRun && (m_PhasesLeft == 0)))
+    {
+        m_Signal.wait(lock);
+    }
+    --m_NumWaiting;
+
+    return !m_bQuit;
+}
+
+long long JobSystem::getTimeNs() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_RunStart).count();
+}
@@ -0,0 +1,137 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "PhaseGraph.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that run the phases of a PhaseGraph.  The 
+// thread that calls run() works too, so a system with one thread just runs 
+// everything inline, in the order the phases were added.
+//
+// Each thread has its own queue of jobs.  A job is a range of one phase's 
+// items.  Before a thread does a job that's bigger than the phase's grain, it
+// splits off the back half and puts it in its queue, so a phase starts out as
+// a single job and only gets broken up as far as there are threads to share
+// it with.  A thread works on its own queue newest first (the job it split 
+// off last is the one whose data it has most recently touched), and when 
+// that's empty it steals the oldest job from somebody else's, which is the
+// biggest one they have.
+//
+// NOTE: Which thread does which items changes from run to run.  The phases 
+// have to give the same results no matter how they're split up, which means
+// each item may only write its own state.
+class JobSystem
+{
+public:
+    // Zero means one thread per hardware thread.
+    explicit JobSystem(unsigned int numThreads);
+    ~JobSystem();
+
+    // Counts the calling thread.  Thread indices go from 0 (the caller) to
+    //  getNumThreads() - 1, so they can be used to pick per-thread buffers.
+    unsigned int getNumThreads() const { return m_NumThreads; }
+
+    // Runs every phase in the graph, each one once all of its dependencies 
+    //  are done, and returns when they all are.  Doesn't allocate.
+    void run(PhaseGraph& graph);
+
+private:
+    struct Job
+    {
+        unsigned int m_Phase;
+        unsigned int m_Begin;
+        unsigned int m_End;
+    };
+
+    // One thread's jobs.  The owner pushes and pops at the back, and thieves
+    //  take from the front.
+    class JobQueue
+    {
+    public:
+        JobQueue() : m_Head(0), m_Count(0) {}
+
+        // Returns false if the queue is full.
+        bool push(const Job& job);
+        bool popBack(Job& job);
+        bool popFront(Job& job);
+
+    private:
+        // Each phase that's running at once only ever has a few jobs waiting
+        //  in any one queue (a phase of n items is split at most log2(n) 
+        //  times before a piece is done), so this is plenty.
+        static const unsigned int ksCapacity = 256;
+
+        std::mutex m_Mutex;
+        Job m_Jobs[ksCapacity];
+        unsigned int m_Head;
+        unsigned int m_Count;
+    };
+
+    void workerMain(unsigned int threadIndex);
+
+    // Returns false if there was nothing to do anywhere.
+    bool getJob(unsigned int threadIndex, Job& job);
+    void doJob(unsigned int threadIndex, Job job);
+    void pushJob(unsigned int threadIndex, const Job& job);
+
+    void makeReady(unsigned int phase, unsigned int threadIndex);
+    void finishPhase(unsigned int phase, unsigned int threadIndex);
+
+    // Wakes up anybody that's waiting for work, or for the run to finish.
+    void signal();
+
+    // Sleeps until signal() is called, unless it has been since we read 
+    //  signalCount (or the run is over, if bForRun).  Returns false if the
+    //  workers should quit.
+    bool waitForSignal(unsigned int signalCount, bool bForRun);
+
+    long long getTimeNs() const;
+
+private:
+    unsigned int m_NumThreads;
+    std::vector<std::thread> m_Threads;
+    JobQueue* m_pQueues;            // one per thread
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    std::atomic<unsigned int> m_SignalCount;
+    std::atomic<unsigned int> m_NumWaiting;
+    bool m_bQuit;
+
+    // The run that's going on
+    PhaseGraph* m_pGraph;
+    std::atomic<unsigned int> m_PhasesLeft;
+    std::chrono::steady_clock::time_point m_RunStart;
+
+private:
+    // DELIBERATELY UNDEFINED
+    JobSystem(const JobSystem& rhs);
+    JobSystem& operator=(const JobSystem& rhs);
+};
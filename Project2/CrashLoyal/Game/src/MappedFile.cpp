@@ -0,0 +1,124 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_pData(NULL)
+    , m_Size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+// NOTE: The view keeps the file open for as long as it's mapped, so we can 
+//  let go of the file (and mapping) handles as soon as we have it.
+#ifdef _WIN32
+bool MappedFile::open(const char* pPath)
+{
+    close();
+
+    HANDLE hFile = CreateFileA(pPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size) || (size.QuadPart <= 0))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+    if (!hMapping)
+        return false;
+
+    void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+    if (!pView)
+        return false;
+
+    m_pData = (const unsigned char*)pView;
+    m_Size = (size_t)size.QuadPart;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_pData)
+    {
+        UnmapViewOfFile(m_pData);
+        m_pData = NULL;
+        m_Size = 0;
+    }
+}
+#else
+bool MappedFile::open(const char* pPath)
+{
+    close();
+
+    const int fd = ::open(pPath, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if ((fstat(fd, &status) != 0) || (status.st_size <= 0))
+    {
+        ::close(fd);
+        return false;
+    }
+
+    void* pView = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (pView == MAP_FAILED)
+        return false;
+
+    m_pData = (const unsigned char*)pView;
+    m_Size = (size_t)status.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_pData)
+    {
+        munmap((void*)m_pData, m_Size);
+        m_pData = NULL;
+        m_Size = 0;
+    }
+}
+#endif
@@ -0,0 +1,53 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+// A whole file, mapped read-only into memory, so that it can be read straight
+// out of the page cache without copying it anywhere first.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Unmaps whatever we had open.  Returns false if the file couldn't be 
+    //  opened or mapped (an empty file can't be mapped).
+    bool open(const char* pPath);
+    void close();
+
+    bool isOpen() const { return !!m_pData; }
+
+    const unsigned char* getData() const { return m_pData; }
+    size_t getSize() const { return m_Size; }
+
+private:
+    const unsigned char* m_pData;
+    size_t m_Size;
+
+private:
+    // DELIBERATELY UNDEFINED
+    MappedFile(const MappedFile& rhs);
+    MappedFile& operator=(const MappedFile& rhs);
+};
@@ -0,0 +1,71 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStore.h"
+#include "PerfCounters.h"
+
+#include <vector>
+
+// How many live mobs per player we make room for up front.  Dead mobs' slots
+//  are reused, so this only needs to cover the most that are alive at once.  
+//  Going over is fine, it just costs an allocation.
+const unsigned int ARENA_MOBS_PER_PLAYER = 256;
+
+// Working memory that lives as long as a match does.  The simulation borrows
+// these buffers every tick instead of making its own, so once they've grown
+// to fit the match, ticking doesn't touch the heap.  Game owns the arenas, so
+// deleting the Game releases everything the match allocated in one go.
+//
+// NOTE: Each thread that ticks the game has its own arena, and a thread only 
+// updates one entity at a time, so the entities that it updates share one set 
+// of buffers.  Each getter empties its buffer (keeping the capacity), so don't
+// hang on to one across another call to the same getter.
+class MatchArena
+{
+public:
+    MatchArena();
+
+    // Makes room for a match with this many mobs (on both sides together).
+    void reserve(unsigned int numMobs);
+
+    // For SpatialGrid::gatherCandidates()
+    std::vector<unsigned int>& getCandidates() { m_Candidates.clear(); return m_Candidates; }
+
+    // For the mobs that a mob is colliding with (see Mob::checkCollision())
+    std::vector<EntityRef>& getCollisions() { m_Collisions.clear(); return m_Collisions; }
+
+    // This thread's share of the tick's counters.  Game merges them at the 
+    //  end of the tick.
+    PerfCounterShard& getCounters() { return m_Counters; }
+
+private:
+    std::vector<unsigned int> m_Candidates;
+    std::vector<EntityRef> m_Collisions;
+    PerfCounterShard m_Counters;
+
+private:
+    // DELIBERATELY UNDEFINED
+    MatchArena(const MatchArena& rhs);
+    MatchArena& operator=(const MatchArena& rhs);
+};
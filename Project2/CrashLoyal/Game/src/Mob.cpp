@@ -22,42 +22,92 @@
 
 #include "Mob.h"
 
+#include "AabbOverlap.h"
 #include "Constants.h"
 #include "Game.h"
 #include "Player.h"
+#include "Profiler.h"
 
 #include <algorithm>
 #include <vector>
 
 
-Mob::Mob(const iEntityStats& stats, const Vec2& pos, bool isNorth)
-	: Entity(stats, pos, isNorth)
-	, m_pWaypoint(NULL)
+Mob::Mob(EntityStore& store, unsigned int index, Position position)
+	: Entity(store, index, (position == ResolvedPosition) ? store.m_Pos[index] : store.m_NextPos[index])
+	, targetPos(store.m_Steering[index].m_TargetPos)
+	, xStop(store.m_Steering[index].m_bXStop)
+	, yStop(store.m_Steering[index].m_bYStop)
+	, moving(store.m_Steering[index].m_bMoving)
 {
-	assert(dynamic_cast<const iEntityStats_Mob*>(&stats) != NULL);
+	assert(!store.holdsBuildings());
 }
 
-void Mob::tick(float deltaTSec)
+Mob::Mob(const EntityRef& ref)
+	: Mob(*ref.m_pStore, (unsigned int)ref.m_Index)
 {
-	// Tick the entity first.  This will pick our target, and attack it if it's in range.
-	Entity::tick(deltaTSec);
+	assert(ref.isValid());
+}
 
+void Mob::integrate(float deltaTSec, MatchArena& arena)
+{
 	// if our target isn't in range, move towards it.
-	if (!targetInRange())
+	moving = !targetInRange();
+	if (moving)
 	{
-		move(deltaTSec);
+		PROFILE_SCOPE("Mob::move");
+		move(deltaTSec, arena);
 	}
 }
 
-void Mob::move(float deltaTSec)
+void Mob::resolveCollisions(float deltaTSec, MatchArena& arena)
+{
+	assert(&m_Pos == &m_Store.m_Pos[m_Index]);
+
+	// Start from wherever we moved to.
+	m_Pos = m_Store.m_NextPos[m_Index];
+
+	// PROJECT 2: This is where your collision code will be called from
+	std::vector<EntityRef>& otherMobs = arena.getCollisions();
+	{
+		PROFILE_SCOPE("checkCollision");
+		checkCollision(otherMobs, arena);
+	}
+	unsigned int numPushes = 0;
+	{
+		PROFILE_SCOPE("processCollision");
+		for (const EntityRef& otherMobRef : otherMobs) {
+			// NOTE: A mob that stood still to attack only gets out of the way 
+			//  of heavier mobs that are walking into it.  They'd have pushed 
+			//  it, but only we get to move ourselves.
+			Mob otherMob(otherMobRef);
+			if (!moving && (!otherMob.isMoving() || (otherMob.getStatRow().m_Mass <= m_StatRow.m_Mass)))
+				continue;
+
+			if (processCollision(otherMob, deltaTSec))
+				++numPushes;
+		}
+		arena.getCounters().add(CollisionPushes, getStatIndex(), numPushes);
+	}
+	if (moving || (numPushes > 0))
+	{
+		PROFILE_SCOPE("Building/river/edges");
+		checkBuildings(deltaTSec);
+		checkRiver(deltaTSec);
+		checkMapEdges(deltaTSec);
+	}
+}
+
+void Mob::move(float deltaTSec, MatchArena& arena)
 {
 	// If we have a target and it's on the same side of the river, we move towards it.
-	//  Otherwise, we move toward the bridge.
+	//  Otherwise, we follow the flow field across a bridge to its side (or to 
+	//  the enemy's side, if we don't have a target).
 	bool bMoveToTarget = false;
-	if (!!m_pTarget)
+	bool imTop = m_Pos.y < (GAME_GRID_HEIGHT / 2);
+	bool otherTop = !isNorth();
+	if (hasTarget())
 	{
-		bool imTop = m_Pos.y < (GAME_GRID_HEIGHT / 2);
-		bool otherTop = m_pTarget->getPosition().y < (GAME_GRID_HEIGHT / 2);
+		otherTop = getTarget().getPosition().y < (GAME_GRID_HEIGHT / 2);
 
 		if (imTop == otherTop)
 		{
@@ -68,32 +118,33 @@ void Mob::move(float deltaTSec)
 	Vec2 destPos;
 	if (bMoveToTarget)
 	{
-		m_pWaypoint = NULL;
-		destPos = m_pTarget->getPosition();
+		destPos = getTarget().getPosition();
 	}
 	else
 	{
-		if (!m_pWaypoint)
-		{
-			m_pWaypoint = pickWaypoint();
-		}
-		destPos = m_pWaypoint ? *m_pWaypoint : m_Pos;
+		destPos = m_Pos + getGame().getFlowField().getDirection(otherTop, m_Pos);
+		arena.getCounters().add(FlowFieldSteps, getStatIndex());
 	}
 
 	targetPos = destPos;
 	Vec2 moveVec = destPos - m_Pos;
 	Vec2 normalizedVec = moveVec / moveVec.length();
-	Vec2 velocityVector = normalizedVec * m_Stats.getSpeed();
+	Vec2 velocityVector = normalizedVec * m_StatRow.m_Speed;
 
 	float distRemaining = moveVec.normalize();
-	float moveDist = m_Stats.getSpeed() * deltaTSec;
+	float moveDist = m_StatRow.m_Speed * deltaTSec;
 
 	if (bMoveToTarget)
 	{
-		assert(m_pTarget);
-		distRemaining -= (m_Stats.getSize() + m_pTarget->getStats().getSize()) / 2.f;
+		assert(hasTarget());
+		distRemaining -= getPairStats(getStatIndex(), getTarget().getStatIndex()).m_CombinedHalfSize;
 		distRemaining = std::max(0.f, distRemaining);
 	}
+	else if (distRemaining > 0.f)
+	{
+		// The flow field keeps going until we're on the right side.
+		distRemaining = FLT_MAX;
+	}
 
 	if (moveDist <= distRemaining)
 	{
@@ -102,21 +153,22 @@ void Mob::move(float deltaTSec)
 		ahead = m_Pos + moveVec;
 		ahead *= MAX_SEE_AHEAD;
 		Vec2 ahead2 = ahead * 0.5;
-		Entity* mostThreateningMob = getMostThreateningMob(ahead, ahead2);
-		if (mostThreateningMob != nullptr) {
+		EntityRef threatRef = getMostThreateningMob(ahead, ahead2, arena);
+		if (threatRef.isValid()) {
+			Entity mostThreateningMob(threatRef);
 			Vec2 avoidanceForce;
-			avoidanceForce = ahead - mostThreateningMob->getPosition();
-			float squareRadius = ((float)sqrt(2) * mostThreateningMob->getStats().getSize()) / 2;
+			avoidanceForce = ahead - mostThreateningMob.getPosition();
+			float squareRadius = mostThreateningMob.getStatRow().m_DiagonalRadius;
 			avoidanceForce.normalize();
 			Vec2 force = avoidanceForce * squareRadius;
-			Vec2 acc = force / m_Stats.getMass();
+			Vec2 acc = force / m_StatRow.m_Mass;
 
 			Vec2 newVelocity = acc * deltaTSec; // <-- velocity
 			Vec2 nextNewVelocity = velocityVector + newVelocity;
 
-			if (nextNewVelocity.length() > m_Stats.getSpeed()) {
+			if (nextNewVelocity.length() > m_StatRow.m_Speed) {
 				nextNewVelocity = nextNewVelocity / nextNewVelocity.length();
-				nextNewVelocity *= m_Stats.getSpeed();
+				nextNewVelocity *= m_StatRow.m_Speed;
 			}
 			m_Velocity = nextNewVelocity;
 			if (xStop) {
@@ -139,9 +191,9 @@ void Mob::move(float deltaTSec)
 			}
 			Vec2 velocityNormal;
 			Vec2 offset;
-			if (velocity.length() > m_Stats.getSpeed()) {
+			if (velocity.length() > m_StatRow.m_Speed) {
 				velocity /= velocity.length();
-				velocity *= m_Stats.getSpeed();
+				velocity *= m_StatRow.m_Speed;
 			}
 			Vec2 distance = velocity * deltaTSec;
 
@@ -149,91 +201,20 @@ void Mob::move(float deltaTSec)
 			m_Pos = nextPos;
 		}
 	}
-	else
-	{
-		 // if the destination was a waypoint, find the next one and continue movement
-		if (m_pWaypoint)
-		{
-			m_pWaypoint = pickWaypoint();
-		}
-	}
-
-	// PROJECT 2: This is where your collision code will be called from
-	// Mob* otherMob = checkCollision();
-	// Might be better to do this before the position has been updated. Mgiht make it smoother. 
-	std::vector<Entity*> otherMobs = checkCollision();
-	for (Entity* otherMob : otherMobs) {
-		if (otherMob) {
-			processCollision(otherMob, deltaTSec);
-		}
-	}
-	checkBuildings(deltaTSec, true);
-	checkBuildings(deltaTSec, false);
-	checkRiver(deltaTSec);
-	checkMapEdges(deltaTSec);
-}
-
-// Determine if the given Vec2 position is going outside of the map. 
-bool Mob::checkMapEdgesCollides(Vec2 newPos) {
-	// Out of right side of map{
-	if (newPos.x > GAME_GRID_WIDTH) {
-		return true;
-	}
-	// Out of left side of map
-	if (newPos.x < 0.0f) {
-		return true;
-	}
-	// Out of bottom side of map
-	if (newPos.y > GAME_GRID_HEIGHT) {
-		return true;
-	}
-	// Out of top side of map
-	if (newPos.y < 0) {
-		return true;
-	}
-	return false;
 }
 
-// Determine if the given Vec2 position is overlapping with the river.
-bool Mob::checkRiverEdgesCollides(Vec2 newPos) {
-	std::shared_ptr<Vec2>river;
-	// Make a Vec2 for the river edges depending on what edges the collision is occuring. 
-	// Left river
-	if (newPos.x >= RIVER_LEFT_X
-		&& newPos.x <= RIVER_LEFT_X + (LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.0)
-		&& newPos.y >= RIVER_TOP_Y
-		&& newPos.y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2(RIVER_LEFT_X, RIVER_TOP_Y));
-	}
-	// Middle river
-	else if (newPos.x >= (RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5)
-		&& newPos.x <= (RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5) + (SCREEN_WIDTH_PIXELS - RIGHT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.0)
-		&& newPos.y >= RIVER_TOP_Y
-		&& newPos.y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2((RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5), RIVER_TOP_Y));
-	}
-	// Right river
-	else if (newPos.x >= (LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5)
-		&& newPos.x <= (LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5) + (RIGHT_BRIDGE_CENTER_X - LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH)
-		&& newPos.y >= RIVER_TOP_Y
-		&& newPos.y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2((LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5), RIVER_TOP_Y));
-	}
-	else {
-		// Does not overlap with river
-		xStop = false;
-		return false;
-	}
-	xStop = true;
-	return true;
+// Determine if the given Vec2 position is off the map, in the river, or 
+// overlapping a tower.
+bool Mob::isBlocked(Vec2 newPos) {
+	return getGame().getCollisionField().isBlocked(newPos, getStatIndex());
 }
 
 // Check if the mob is colliding with or overlapping with the edge of the map screen. 
 // If it is, make adjustments to the mob's position to avoid the mob going outside of the map.
 bool Mob::checkMapEdges(float elapsedTime) {
-	float shiftSize = this->getStats().getSize();
-	float mobSize = this->getStats().getSize();
-	float maxDist = m_Stats.getSpeed() * elapsedTime;
+	float shiftSize = m_StatRow.m_Size;
+	float mobSize = m_StatRow.m_Size;
+	float maxDist = m_StatRow.m_Speed * elapsedTime;
 	Vec2 p = Vec2(this->m_Pos.x - targetPos.x, this->m_Pos.y - targetPos.y);
 	p.normalize();
 	bool adjusted = false;
@@ -278,7 +259,7 @@ bool Mob::checkMapEdges(float elapsedTime) {
 		yStop = false;
 	}
 	if (adjusted) {
-		p *= (float)this->getStats().getSpeed();
+		p *= (float)m_StatRow.m_Speed;
 		p *= (float)elapsedTime;
 		m_Pos += p;
 		return true;
@@ -291,55 +272,22 @@ bool Mob::checkMapEdges(float elapsedTime) {
 // If it is, make adjustments to the mob's position to avoid collision/overlap. 
 void Mob::checkRiver(float elapsedTime) {
 	float shiftSize = 0.5f;
-	float maxDist = m_Stats.getSpeed() * elapsedTime;
-	std::shared_ptr<Vec2>river;
-	// Make a Vec2 for the river edges depending on what edges the collision is occuring. 
-	// Left river
-	if (this->getPosition().x >= RIVER_LEFT_X
-		&& this->getPosition().x <= RIVER_LEFT_X + (LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.0)
-		&& this->getPosition().y >= RIVER_TOP_Y
-		&& this->getPosition().y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2(RIVER_LEFT_X, RIVER_TOP_Y));
-	}
-	// Middle river
-	else if (this->getPosition().x >= (RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5)
-		&& this->getPosition().x <= (RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5) + (SCREEN_WIDTH_PIXELS - RIGHT_BRIDGE_CENTER_X - BRIDGE_WIDTH / 2.0)
-		&& this->getPosition().y >= RIVER_TOP_Y
-		&& this->getPosition().y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2((RIGHT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5), RIVER_TOP_Y));
-	}
-	// Right river
-	else if (this->getPosition().x >= (LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5)
-		&& this->getPosition().x <= (LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5) + (RIGHT_BRIDGE_CENTER_X - LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH)
-		&& this->getPosition().y >= RIVER_TOP_Y
-		&& this->getPosition().y <= RIVER_TOP_Y + (RIVER_BOT_Y - RIVER_TOP_Y)) {
-		river = std::make_shared<Vec2>(Vec2((LEFT_BRIDGE_CENTER_X + BRIDGE_WIDTH / 2.0 - 0.5), RIVER_TOP_Y));
-	}
-	else {
+	float maxDist = m_StatRow.m_Speed * elapsedTime;
+	const CollisionField::RiverPush push = getGame().getCollisionField().getRiverPush(m_Pos);
+	if (push == CollisionField::RiverNone) {
 		// Does not overlap with river
 		return;
 	}
 	Vec2 p = Vec2(this->m_Pos.x - targetPos.x, this->m_Pos.y - targetPos.y);
 	p.normalize();
-	if (river->x == (BRIDGE_WIDTH + LEFT_BRIDGE_CENTER_X / 2.0) - 0.5) {
-		if (this->m_Pos.x > river->x + ((RIGHT_BRIDGE_CENTER_X - LEFT_BRIDGE_CENTER_X - BRIDGE_WIDTH) / 2)) {
-			shiftSize = std::min(maxDist, shiftSize);
-			p.x += shiftSize;
-		}
-		else {
-			shiftSize = std::min(maxDist, shiftSize);
-			p.x -= shiftSize;
-		}
-	}
-	else if (river->x == RIVER_LEFT_X) {
-		shiftSize = std::min(maxDist, shiftSize);
+	shiftSize = std::min(maxDist, shiftSize);
+	if (push == CollisionField::RiverPushRight) {
 		p.x += shiftSize;
 	}
 	else {
-		shiftSize = std::min(maxDist, shiftSize);
 		p.x -= shiftSize;
 	}
-	p *= (float)this->getStats().getSpeed();
+	p *= (float)m_StatRow.m_Speed;
 	p *= (float)elapsedTime;
 	m_Pos += p;
 }
@@ -347,17 +295,21 @@ void Mob::checkRiver(float elapsedTime) {
 // Check if any other mob is colliding with the mob. 
 // If it is, make adjustments to the mob's position to avoid collision. 
 // Do this while considering if the adjustment will cause any other collisions for the river, map, and buildings.
-void Mob::processCollision(Entity* otherMob, float elapsedTime) {
-	float shiftVal = 0.1f;
-	float maxDist = m_Stats.getSpeed() * elapsedTime;
-	bool pushedBack = false;
-	Vec2 p = Vec2(this->m_Pos.x - otherMob->getPosition().x,
-		this->m_Pos.y - otherMob->getPosition().y);
+// NOTE: We only ever move ourselves.  The lighter mob gets out of the way of
+// the heavier one (and if they weigh the same, they both move), so a heavy 
+// mob still shoves the light ones aside - they just do it themselves.
+bool Mob::processCollision(const Entity& otherMob, float elapsedTime) {
+	if (m_StatRow.m_Mass > otherMob.getStatRow().m_Mass) {
+		return false;
+	}
+
+	float maxDist = m_StatRow.m_Speed * elapsedTime;
+	Vec2 p = Vec2(this->m_Pos.x - otherMob.getPosition().x,
+		this->m_Pos.y - otherMob.getPosition().y);
 	p.normalize();
-	float otherMobHalfSize = (float)otherMob->getStats().getSize() / 2;
-	Vec2 otherMobPos = otherMob->getPosition();
-	float thisSize = this->getStats().getSize();
-	float halfSize = (float)thisSize / 2;
+	float otherMobHalfSize = otherMob.getStatRow().m_HalfSize;
+	Vec2 otherMobPos = otherMob.getPosition();
+	float halfSize = m_StatRow.m_HalfSize;
 
 	float r1RightEdge = otherMobPos.x + otherMobHalfSize;
 	float r1LeftEdge = otherMobPos.x - otherMobHalfSize;
@@ -371,10 +323,7 @@ void Mob::processCollision(Entity* otherMob, float elapsedTime) {
 
 	// Determine if there is a collision, then calculate how much 
 	// to shift and make adjustments by negating the edges. 
-	if (r1RightEdge >= r2LeftEdge &&
-		r1LeftEdge <= r2RightEdge &&
-		r1TopEdge >= r2BottomEdge &&
-		r1BottomEdge <= r2TopEdge) {
+	if (aabbOverlaps(otherMobPos, otherMobHalfSize, m_Pos, halfSize)) {
 		float shiftSize;
 		if (r1RightEdge >= r2LeftEdge) {
 			shiftSize = r1RightEdge - r2LeftEdge;
@@ -398,286 +347,172 @@ void Mob::processCollision(Entity* otherMob, float elapsedTime) {
 		}
 	}
 
-	if (this->getStats().getMass() > otherMob->getStats().getMass()) {
-		pushedBack = true;
-	}
-
-	if (pushedBack) {
-		p *= (float)otherMob->getStats().getSpeed();
-		p *= (float)elapsedTime;
-
-		Vec2 tempPos = otherMob->m_Pos - p;
-		if (!checkMapEdgesCollides(tempPos) && !checkRiverEdgesCollides(tempPos)
-			&& !checkBuildingsCollides(tempPos, true)
-			&& !checkBuildingsCollides(tempPos, false)) {
-			otherMob->m_Pos -= p;
-		}
-	}
-	else {
-		p *= (float)this->getStats().getSpeed();
-		p *= (float)elapsedTime;
-		Vec2 tempPos = m_Pos - p;
-		if (!checkMapEdgesCollides(tempPos) && !checkRiverEdgesCollides(tempPos)
-			&& !checkBuildingsCollides(tempPos, true)
-			&& !checkBuildingsCollides(tempPos, false)) {
-			m_Pos += p;
-		}
+	p *= (float)m_StatRow.m_Speed;
+	p *= (float)elapsedTime;
+	Vec2 tempPos = m_Pos + p;
+	if (!isBlocked(tempPos)) {
+		m_Pos = tempPos;
+		return true;
 	}
-}
 
-// Determine if the given Vec2 position is overlapping/colliding with the building.
-bool Mob::checkBuildingsCollides(Vec2 newPos, bool isNorth) {
-	const Player& player = Game::get().getPlayer(isNorth);
-	for (Entity* building : player.getBuildings())
-	{
-		float buildingHalfSize = building->getStats().getSize() / 2;
-		Vec2 buildingPos = building->getPosition();
-		float r1RightEdge = buildingPos.x + buildingHalfSize;
-		float r1LeftEdge = buildingPos.x - buildingHalfSize;
-		float r1TopEdge = buildingPos.y + buildingHalfSize;
-		float r1BottomEdge = buildingPos.y - buildingHalfSize;
-
-		float thisSize = this->getStats().getSize();
-		float halfSize = (float)thisSize / 2;
-		float r2RightEdge = newPos.x + halfSize;
-		float r2LeftEdge = newPos.x - halfSize;
-		float r2TopEdge = newPos.y + halfSize;
-		float r2BottomEdge = newPos.y - halfSize;
-
-		if (r1RightEdge >= r2LeftEdge &&
-			r1LeftEdge <= r2RightEdge &&
-			r1TopEdge >= r2BottomEdge &&
-			r1BottomEdge <= r2TopEdge) {
-			Vec2 p = Vec2(newPos.x - building->getPosition().x,
-				newPos.y - building->getPosition().y);
-			p.normalize();
-			if (r1RightEdge >= r2LeftEdge) {
-				xStop = true;
-				return true;
-			}
-			else if (r1LeftEdge <= r2RightEdge) {
-				xStop = true;
-				return true;
-			}
-			else if (r1TopEdge >= r2BottomEdge) {
-				yStop = true;
-				return true;
-			}
-			else if (r1BottomEdge <= r2TopEdge) {
-				yStop = true;
-				return true;
-			}
-		}
-	}
-	yStop = false;
-	xStop = false;
 	return false;
 }
 
 // Check if any building is colliding with the mob. 
 // If it is, make adjustments to the mob's position to avoid collision. 
-void Mob::checkBuildings(float elapsedTime, bool isNorth) {
-	float shiftSizeNew = 0.f;
-	const Player& player = Game::get().getPlayer(isNorth);
-	Vec2 velocityVec;
-	float maxDist = m_Stats.getSpeed() * elapsedTime;
-	bool collides = false;
-	for (Entity* building : player.getBuildings())
+void Mob::checkBuildings(float elapsedTime) {
+	const CollisionField& field = getGame().getCollisionField();
+	float maxDist = m_StatRow.m_Speed * elapsedTime;
+	for (unsigned int i = 0; i < field.getNumTowers(); ++i)
 	{
-		float buildingHalfSize = building->getStats().getSize() / 2;
-		Vec2 buildingPos = building->getPosition();
+		// NOTE: Being pushed away from one tower can push us into the next 
+		//  one, so look again from wherever we are now.
+		if (!(field.getTowerMask(m_Pos, getStatIndex()) & (1u << i))
+			|| !field.overlapsTower(i, m_Pos, getStatIndex())) {
+			continue;
+		}
+
+		float buildingHalfSize = field.getTowerHalfSize(i);
+		Vec2 buildingPos = field.getTowerPosition(i);
 		float r1RightEdge = buildingPos.x + buildingHalfSize;
-		float r1LeftEdge = buildingPos.x - buildingHalfSize;
-		float r1TopEdge = buildingPos.y + buildingHalfSize;
-		float r1BottomEdge = buildingPos.y - buildingHalfSize;
-
-		float thisSize = this->getStats().getSize();
-		float halfSize = (float)thisSize / 2;
-		float r2RightEdge = m_Pos.x + halfSize;
-		float r2LeftEdge = m_Pos.x - halfSize;
-		float r2TopEdge = m_Pos.y + halfSize;
-		float r2BottomEdge = m_Pos.y - halfSize;
-
-		// Determine if there is a collision, then calculate how much 
-		// to shift and make adjustments by negating the edges. 
-		if (r1RightEdge >= r2LeftEdge &&
-			r1LeftEdge <= r2RightEdge &&
-			r1TopEdge >= r2BottomEdge &&
-			r1BottomEdge <= r2TopEdge) {
-			float shiftSize;
-			Vec2 p = Vec2(this->getPosition().x - building->getPosition().x,
-				this->getPosition().y - building->getPosition().y);
-			p.normalize();
-			if (r1RightEdge >= r2LeftEdge) {
-				shiftSize = r1RightEdge - r2LeftEdge;
-				shiftSize = std::min(maxDist, shiftSize);
-				p.x += shiftSize;
-				collides = true;
-			}
-			else if (r1LeftEdge <= r2RightEdge) {
-				shiftSize = r2RightEdge - r1LeftEdge;
-				shiftSize = std::min(maxDist, shiftSize);
-				p.x -= shiftSize;
-				collides = true;
-			}
-			else if (r1TopEdge >= r2BottomEdge) {
-				shiftSize = r1TopEdge - r2BottomEdge;
-				shiftSize = std::min(maxDist, shiftSize);
-				p.y += shiftSize;
-				collides = true;
-			}
-			else if (r1BottomEdge <= r2TopEdge) {
-				shiftSize = r2TopEdge - r1BottomEdge;
-				shiftSize = std::min(maxDist, shiftSize);
-				p.y -= shiftSize;
-				collides = true;
-			}
+		float r2LeftEdge = m_Pos.x - m_StatRow.m_HalfSize;
+
+		// We're overlapping, so our left edge is always left of its right 
+		//  edge, and that's the way we get pushed.
+		Vec2 p = Vec2(this->getPosition().x - buildingPos.x,
+			this->getPosition().y - buildingPos.y);
+		p.normalize();
+		float shiftSize = r1RightEdge - r2LeftEdge;
+		shiftSize = std::min(maxDist, shiftSize);
+		p.x += shiftSize;
 
-			p *= (float)this->getStats().getSpeed();
-			p *= (float)elapsedTime;
-			m_Pos += p;
-		}
+		p *= (float)m_StatRow.m_Speed;
+		p *= (float)elapsedTime;
+		m_Pos += p;
 	}
 }
 
 // Return the closest mob that is overlapping with the two given vectors. 
-Entity* Mob::getMostThreateningMob(Vec2 ahead, Vec2 ahead2) {
-	Entity* mostThreateningMob = nullptr;
-	const Player& northPlayer = Game::get().getPlayer(true);
-	for (Entity* pOtherMob : northPlayer.getMobs())
-	{
-		if (this == pOtherMob)
-		{
-			continue;
-		}
+EntityRef Mob::getMostThreateningMob(Vec2 ahead, Vec2 ahead2, MatchArena& arena) {
+	EntityRef mostThreateningMob;
+	float mostThreateningDist = 0.f;
+	const EntityRef self = getRef();
+
+	Game& game = getGame();
+	if (game.getUseMobGrid()) {
+		// A mob can only overlap a point if its center is within its radius
+		//  (see lineIntersectsMob()) of that point.
+		const float radius = (((float)sqrt(2) * game.getMaxMobSize()) / 2) + 0.01f;
+		const Vec2 pad(radius, radius);
+		const SpatialGrid& grid = game.getMobGrid();
+
+		std::vector<unsigned int>& candidates = arena.getCandidates();
+		grid.gatherCandidates(ahead - pad, ahead + pad, candidates);
+		grid.gatherCandidates(ahead2 - pad, ahead2 + pad, candidates);
+		SpatialGrid::sortCandidates(candidates);
+
+		for (unsigned int i : candidates) {
+			const EntityRef otherRef = grid.getEntity(i);
+			if (self == otherRef)
+			{
+				continue;
+			}
 
-		bool collision = lineIntersectsMob(ahead, ahead2, pOtherMob);
-		if (collision && (mostThreateningMob == nullptr || m_Pos.dist(pOtherMob->getPosition()) < m_Pos.dist(mostThreateningMob->getPosition()))) {
-			mostThreateningMob = pOtherMob;
+			Entity otherMob(otherRef);
+			bool collision = lineIntersectsMob(ahead, ahead2, otherMob);
+			if (collision && (!mostThreateningMob.isValid() || m_Pos.dist(otherMob.getPosition()) < mostThreateningDist)) {
+				mostThreateningMob = otherRef;
+				mostThreateningDist = m_Pos.dist(otherMob.getPosition());
+			}
 		}
+
+		return mostThreateningMob;
 	}
 
-	const Player& southPlayer = Game::get().getPlayer(false);
-	for (Entity* pOtherMob : southPlayer.getMobs())
+	for (int north = 1; north >= 0; --north)
 	{
-		if (this == pOtherMob)
+		EntityStore& mobs = game.getPlayer(!!north).getMobs();
+		for (unsigned int i = 0; i < mobs.size(); ++i)
 		{
-			continue;
-		}
-		bool collision = lineIntersectsMob(ahead, ahead2, pOtherMob);
-		if (collision && (mostThreateningMob == nullptr || m_Pos.dist(pOtherMob->getPosition()) < m_Pos.dist(mostThreateningMob->getPosition()))) {
-			mostThreateningMob = pOtherMob;
+			Entity otherMob(mobs, i);
+			if (self == otherMob.getRef())
+			{
+				continue;
+			}
+
+			bool collision = lineIntersectsMob(ahead, ahead2, otherMob);
+			if (collision && (!mostThreateningMob.isValid() || m_Pos.dist(otherMob.getPosition()) < mostThreateningDist)) {
+				mostThreateningMob = otherMob.getRef();
+				mostThreateningDist = m_Pos.dist(otherMob.getPosition());
+			}
 		}
 	}
 	return mostThreateningMob;
 }
 
 // Calculate the distance in float of the mob and the given vector (ahead vector). 
-float distance(Entity* mob1, Vec2 ahead) {
-	return sqrt((mob1->getPosition().x - ahead.x) * (mob1->getPosition().x - ahead.x) +
-		(mob1->getPosition().y - ahead.y) * (mob1->getPosition().y - ahead.y));
+float distance(const Entity& mob1, Vec2 ahead) {
+	return sqrt((mob1.getPosition().x - ahead.x) * (mob1.getPosition().x - ahead.x) +
+		(mob1.getPosition().y - ahead.y) * (mob1.getPosition().y - ahead.y));
 }
 
 // Determine if the two given ahead vectors intersect and overlap with the given mob's position.
-bool Mob::lineIntersectsMob(Vec2 ahead, Vec2 ahead2, Entity* mob) {
-	float mobRadius = ((float)sqrt(2) * mob->getStats().getSize()) / 2;
+bool Mob::lineIntersectsMob(Vec2 ahead, Vec2 ahead2, const Entity& mob) {
+	float mobRadius = mob.getStatRow().m_DiagonalRadius;
 
 	return distance(mob, ahead) <= mobRadius || distance(mob, ahead2) <= mobRadius;
 }
 
-const Vec2* Mob::pickWaypoint()
-{
-	float smallestDistSq = FLT_MAX;
-	const Vec2* pClosest = NULL;
-
-	for (const Vec2& pt : Game::get().getWaypoints())
-	{
-		// Filter out any waypoints that are behind (or barely in front of) us.
-		// NOTE: (0, 0) is the top left corner of the screen
-		float yOffset = pt.y - m_Pos.y;
-		if ((m_bNorth && (yOffset < 1.f)) ||
-			(!m_bNorth && (yOffset > -1.f)))
-		{
-			continue;
-		}
-
-		float distSq = m_Pos.distSqr(pt);
-		if (distSq < smallestDistSq) {
-			smallestDistSq = distSq;
-			pClosest = &pt;
-		}
-	}
-
-	return pClosest;
-}
-
 // PROJECT 2: 
 //  1) return a vector of mobs that we're colliding with
 //  2) handle collision with towers & river 
-std::vector<Entity*> Mob::checkCollision()
+void Mob::checkCollision(std::vector<EntityRef>& collidingMobs, MatchArena& arena)
 {
-	float halfSize = this->getStats().getSize() / 2;
-	Vec2 thisPos = this->getPosition();
+	const EntityRef self = getRef();
 
-	std::vector<Entity*> collidingMobs;
-	const Player& northPlayer = Game::get().getPlayer(true);
-	for (Entity* pOtherMob : northPlayer.getMobs())
+	Game& game = getGame();
+	if (game.getUseMobGrid())
 	{
-		if (this == pOtherMob)
+		// The grid does the same test as overlapsMob(), several mobs at a time.
+		const SpatialGrid& grid = game.getBroadphaseGrid();
+		std::vector<unsigned int>& hits = arena.getCandidates();
+		const unsigned int numTested = grid.gatherOverlaps(m_Pos, m_StatRow.m_HalfSize, game.getMaxMobSize() / 2, hits);
+		SpatialGrid::sortCandidates(hits);
+		arena.getCounters().add(BroadphaseCandidates, getStatIndex(), numTested);
+
+		for (unsigned int i : hits)
 		{
-			continue;
-		}
-		// PROJECT 2: YOUR CODE CHECKING FOR A COLLISION GOES HERE
-		float mobHalfSize = (float)pOtherMob->getStats().getSize() / 2;
-		Vec2 mobPos = pOtherMob->getPosition();
-
-		float r1RightEdge = mobPos.x + mobHalfSize;
-		float r1LeftEdge = mobPos.x - mobHalfSize;
-		float r1TopEdge = mobPos.y + mobHalfSize;
-		float r1BottomEdge = mobPos.y - mobHalfSize;
-
-		float r2RightEdge = thisPos.x + halfSize;
-		float r2LeftEdge = thisPos.x - halfSize;
-		float r2TopEdge = thisPos.y + halfSize;
-		float r2BottomEdge = thisPos.y - halfSize;
-
-		if (r1RightEdge >= r2LeftEdge &&
-			r1LeftEdge <= r2RightEdge &&
-			r1TopEdge >= r2BottomEdge &&
-			r1BottomEdge <= r2TopEdge) {
-			collidingMobs.push_back(pOtherMob);
+			const EntityRef otherRef = grid.getEntity(i);
+			if (self != otherRef)
+			{
+				collidingMobs.push_back(otherRef);
+			}
 		}
+
+		arena.getCounters().add(NarrowphaseHits, getStatIndex(), (unsigned int)collidingMobs.size());
+		return;
 	}
 
-	const Player& southPlayer = Game::get().getPlayer(false);
-	for (Entity* pOtherMob : southPlayer.getMobs())
+	for (int north = 1; north >= 0; --north)
 	{
-		if (this == pOtherMob)
+		EntityStore& mobs = game.getPlayer(!!north).getMobs();
+		for (unsigned int i = 0; i < mobs.size(); ++i)
 		{
-			continue;
-		}
-
-		// PROJECT 2: YOUR CODE CHECKING FOR A COLLISION GOES HERE
-		float mobHalfSize = (float)pOtherMob->getStats().getSize() / 2;
-		Vec2 mobPos = pOtherMob->getPosition();
-
-		float r1RightEdge = mobPos.x + mobHalfSize;
-		float r1LeftEdge = mobPos.x - mobHalfSize;
-		float r1TopEdge = mobPos.y + mobHalfSize;
-		float r1BottomEdge = mobPos.y - mobHalfSize;
-
-		float r2RightEdge = thisPos.x + halfSize;
-		float r2LeftEdge = thisPos.x - halfSize;
-		float r2TopEdge = thisPos.y + halfSize;
-		float r2BottomEdge = thisPos.y - halfSize;
-
-		if (r1RightEdge >= r2LeftEdge &&
-			r1LeftEdge <= r2RightEdge &&
-			r1TopEdge >= r2BottomEdge &&
-			r1BottomEdge <= r2TopEdge) {
-			collidingMobs.push_back(pOtherMob);
+			Mob otherMob(mobs, i);
+			if ((self != otherMob.getRef()) && overlapsMob(otherMob))
+			{
+				collidingMobs.push_back(otherMob.getRef());
+			}
 		}
+		arena.getCounters().add(BroadphaseCandidates, getStatIndex(), mobs.size());
 	}
 
-	return collidingMobs;
-}
\ No newline at end of file
+	arena.getCounters().add(NarrowphaseHits, getStatIndex(), (unsigned int)collidingMobs.size());
+}
+
+// Determine if the given mob's square overlaps with ours.
+bool Mob::overlapsMob(const Entity& otherMob)
+{
+	// PROJECT 2: YOUR CODE CHECKING FOR A COLLISION GOES HERE
+	return aabbOverlaps(otherMob.getPosition(), otherMob.getStatRow().m_HalfSize, m_Pos, m_StatRow.m_HalfSize);
+}
@@ -24,31 +24,58 @@
 
 #include "Entity.h"
 
+// NOTE: A Mob view's m_Pos is normally the mob's next position 
+// (EntityStore::m_NextPos).  That's what it moves during integration, while 
+// everybody else still sees where it was at the start of the tick, and it's 
+// what the other mobs collide with during resolution.  A ResolvedPosition view
+// works on m_Pos instead, which is where a mob's collisions are resolved to.
 class Mob : public Entity {
 
 public:
-    Mob(const iEntityStats& stats, const Vec2& pos, bool isNorth);
-    virtual void tick(float deltaTSec);
+    enum Position
+    {
+        NextPosition,
+        ResolvedPosition,
+    };
+
+    Mob(EntityStore& store, unsigned int index, Position position = NextPosition);
+    explicit Mob(const EntityRef& ref);
+
+    // Moves toward our target, unless it's already in range.
+    void integrate(float deltaTSec, MatchArena& arena);
+
+    // Pushes us out of the other mobs, the towers, the river and the map 
+    //  edges, starting from wherever integrate() moved us to.  Only for 
+    //  ResolvedPosition views.
+    void resolveCollisions(float deltaTSec, MatchArena& arena);
+
+    // False if we stood still this tick to attack.
+    bool isMoving() const { return moving; }
 
 protected:
-    void move(float deltaTSec);
-    const Vec2* pickWaypoint();
-    std::vector<Entity*> checkCollision();
+    void move(float deltaTSec, MatchArena& arena);
 
-    // Return the closest mob that is overlapping with the two given vectors. 
-    Entity* getMostThreateningMob(Vec2 ahead, Vec2 ahead2);
+    // Fills in the mobs that we're colliding with (at their next positions).
+    void checkCollision(std::vector<EntityRef>& collidingMobs, MatchArena& arena);
+
+    // Determine if the given mob's square overlaps with ours.
+    bool overlapsMob(const Entity& otherMob);
+
+    // Return the closest mob that is overlapping with the two given vectors (or an invalid ref). 
+    EntityRef getMostThreateningMob(Vec2 ahead, Vec2 ahead2, MatchArena& arena);
 
     // Determine if the two given ahead vectors intersect and overlap with the given mob's position.
-    bool lineIntersectsMob(Vec2 ahead, Vec2 ahead2, Entity* mob);
+    bool lineIntersectsMob(Vec2 ahead, Vec2 ahead2, const Entity& mob);
 
     // Check if any other mob is colliding with the mob. 
     // If it is, make adjustments to the mob's position to avoid collision. 
     // Do this while considering if the adjustment will cause any other collisions for the river, map, and buildings.
-    void processCollision(Entity* otherMob, float elapsedTime);
+    // Returns true if we moved.
+    bool processCollision(const Entity& otherMob, float elapsedTime);
 
     // Check if any building is colliding with the mob. 
     // If it is, make adjustments to the mob's position to avoid collision. 
-    void checkBuildings(float elapsedTime, bool isNorth);
+    void checkBuildings(float elapsedTime);
 
     // Check if the mob is colliding with or overlapping with the river. 
     // If it is, make adjustments to the mob's position to avoid collision/overlap. 
@@ -58,18 +85,14 @@ protected:
     // If it is, make adjustments to the mob's position to avoid the mob going outside of the map.
     bool checkMapEdges(float elapsedTime);
 
-    // Determine if the given Vec2 position is going outside of the map. 
-    bool checkMapEdgesCollides(Vec2 newPos);
-
-    // Determine if the given Vec2 position is overlapping with the river.
-    bool checkRiverEdgesCollides(Vec2 newPos);
-
-    // Determine if the given Vec2 position is overlapping/colliding with the building.
-    bool checkBuildingsCollides(Vec2 newPos, bool isNorth);
+    // Determine if the given Vec2 position is off the map, in the river, or 
+    // overlapping a tower (see CollisionField).
+    bool isBlocked(Vec2 newPos);
 
 private:
-    const Vec2* m_pWaypoint;
-    Vec2 targetPos;
-    bool xStop;
-    bool yStop;
+    // These all live in our store's m_Steering (see MobSteering)
+    Vec2& targetPos;
+    bool& xStop;
+    bool& yStop;
+    bool& moving;
 };
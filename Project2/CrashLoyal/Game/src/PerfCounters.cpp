@@ -0,0 +1,134 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PerfCounters.h"
+
+#include "EntityStatTable.h"
+
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+
+static const char* const ksCounterNames[] =
+{
+    "broadphase_candidates",
+    "narrowphase_hits",
+    "collision_pushes",
+    "target_scans",
+    "target_cache_hits",
+    "flow_field_steps",
+    "attacks",
+    "deaths",
+};
+static_assert(sizeof(ksCounterNames) / sizeof(ksCounterNames[0]) == NumPerfCounters, "ksCounterNames is out of synch with PerfCounter");
+
+static const char* const ksGaugeNames[] =
+{
+    "north_mobs",
+    "south_mobs",
+    "north_towers",
+    "south_towers",
+    "tick_ms",
+};
+static_assert(sizeof(ksGaugeNames) / sizeof(ksGaugeNames[0]) == NumPerfGauges, "ksGaugeNames is out of synch with PerfGauge");
+
+void PerfCounterShard::clear()
+{
+    memset(m_Counts, 0, sizeof(m_Counts));
+}
+
+void PerfCounters::clear()
+{
+    memset(m_Counts, 0, sizeof(m_Counts));
+    for (double& gauge : m_Gauges)
+    {
+        gauge = 0.0;
+    }
+}
+
+void PerfCounters::add(const PerfCounterShard& shard)
+{
+    for (unsigned int c = 0; c < NumPerfCounters; ++c)
+    {
+        for (unsigned int k = 0; k < NUM_PERF_KINDS; ++k)
+        {
+            m_Counts[c][k] += shard.m_Counts[c][k];
+        }
+    }
+}
+
+void PerfCounters::add(const PerfCounters& counters)
+{
+    for (unsigned int c = 0; c < NumPerfCounters; ++c)
+    {
+        for (unsigned int k = 0; k < NUM_PERF_KINDS; ++k)
+        {
+            m_Counts[c][k] += counters.m_Counts[c][k];
+        }
+    }
+    memcpy(m_Gauges, counters.m_Gauges, sizeof(m_Gauges));
+}
+
+unsigned long long PerfCounters::get(PerfCounter counter) const
+{
+    unsigned long long total = 0;
+    for (unsigned long long count : m_Counts[counter])
+    {
+        total += count;
+    }
+    return total;
+}
+
+const char* PerfCounters::getName(PerfCounter counter)
+{
+    return ksCounterNames[counter];
+}
+
+const char* PerfCounters::getName(PerfGauge gauge)
+{
+    return ksGaugeNames[gauge];
+}
+
+void PerfCounters::write(std::ostream& out) const
+{
+    out << "  " << std::left << std::setw(24) << "Counter" << std::right << std::setw(14) << "Total";
+    for (int t = 0; t < iEntityStats::numMobTypes; ++t)
+    {
+        out << std::setw(12) << ENTITY_STATS[getStatIndex((iEntityStats::MobType)t)].m_Name;
+    }
+    out << std::setw(12) << "Buildings" << std::endl;
+
+    for (unsigned int c = 0; c < NumPerfCounters; ++c)
+    {
+        out << "  " << std::left << std::setw(24) << ksCounterNames[c] << std::right << std::setw(14) << get((PerfCounter)c);
+        for (unsigned int k = 0; k < NUM_PERF_KINDS; ++k)
+        {
+            out << std::setw(12) << m_Counts[c][k];
+        }
+        out << std::endl;
+    }
+
+    for (unsigned int g = 0; g < NumPerfGauges; ++g)
+    {
+        out << "  " << std::left << std::setw(24) << ksGaugeNames[g] << std::right << std::setw(14) << m_Gauges[g] << std::endl;
+    }
+}
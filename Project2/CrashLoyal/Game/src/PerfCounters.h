@@ -0,0 +1,116 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStats.h"
+
+#include <iosfwd>
+
+// What the simulation counts as it ticks.  To add one, add it here (before 
+// NumPerfCounters), give it a name in PerfCounters.cpp, and count it with 
+// MatchArena::getCounters().
+enum PerfCounter
+{
+    BroadphaseCandidates,   // mobs that a mob's collision query looked at
+    NarrowphaseHits,        // of those, the ones that it really overlapped
+    CollisionPushes,        // times that processCollision() moved a mob
+    TargetScans,            // times that an entity looked for a new target
+    TargetCacheHits,        // times that an entity kept its locked target without looking
+    FlowFieldSteps,         // moves that followed the flow field (the old waypoints), rather than heading for the target
+    Attacks,
+    Deaths,
+
+    NumPerfCounters
+};
+
+// Values that are set at the end of each tick, rather than counted.
+enum PerfGauge
+{
+    NorthMobsGauge,
+    SouthMobsGauge,
+    NorthTowersGauge,
+    SouthTowersGauge,
+    TickMsGauge,            // wall clock time that the tick took
+
+    NumPerfGauges
+};
+
+// Every count is kept per kind of entity that did it (or, for deaths, that it
+//  happened to): one kind for each MobType, and one more for buildings.
+const unsigned int NUM_PERF_KINDS = iEntityStats::numMobTypes + 1;
+
+// Mobs come first in the stat table, so their stat index is their MobType.
+inline unsigned int getPerfKind(int statIndex)
+{
+    return (statIndex < iEntityStats::numMobTypes) ? (unsigned int)statIndex : (unsigned int)iEntityStats::numMobTypes;
+}
+
+// One thread's counts for the tick that's running.  Nobody else touches them
+//  until the tick is over, so counting is just an add.
+class PerfCounterShard
+{
+public:
+    PerfCounterShard() { clear(); }
+
+    void add(PerfCounter counter, int statIndex, unsigned int count = 1) { m_Counts[counter][getPerfKind(statIndex)] += count; }
+    void clear();
+
+private:
+    friend class PerfCounters;
+    unsigned int m_Counts[NumPerfCounters][NUM_PERF_KINDS];
+};
+
+// The counters and gauges for a tick, or summed over a whole match (or more 
+// than one).  Game merges every thread's shard into them at the end of each 
+// tick (see Game::getTickCounters() and getMatchCounters()).
+class PerfCounters
+{
+public:
+    PerfCounters() { clear(); }
+
+    void clear();
+
+    // Adds up the counts.  The gauges are taken from counters, so that they
+    //  always hold the latest values.
+    void add(const PerfCounterShard& shard);
+    void add(const PerfCounters& counters);
+
+    unsigned long long get(PerfCounter counter) const;
+    unsigned long long get(PerfCounter counter, iEntityStats::MobType type) const { return m_Counts[counter][type]; }
+    unsigned long long getBuildings(PerfCounter counter) const { return m_Counts[counter][iEntityStats::numMobTypes]; }
+
+    double getGauge(PerfGauge gauge) const { return m_Gauges[gauge]; }
+    void setGauge(PerfGauge gauge, double value) { m_Gauges[gauge] = value; }
+
+    // Lower case, with underscores, so that they work as column names.
+    static const char* getName(PerfCounter counter);
+    static const char* getName(PerfGauge gauge);
+
+    // A line for each counter, with its total and how it breaks down by 
+    //  MobType, then a line for each gauge.
+    void write(std::ostream& out) const;
+
+private:
+    unsigned long long m_Counts[NumPerfCounters][NUM_PERF_KINDS];
+    double m_Gauges[NumPerfGauges];
+};
@@ -0,0 +1,241 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PhaseGraph.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+PhaseGraph::PhaseGraph(RangeFunc pRangeFunc, CountFunc pCountFunc, void* pContext)
+    : m_pRangeFunc(pRangeFunc)
+    , m_pCountFunc(pCountFunc)
+    , m_pContext(pContext)
+    , m_NumPhases(0)
+    , m_LastRunTime(0.0)
+{
+    resetTotals();
+}
+
+unsigned int PhaseGraph::addPhase(const char* pName, unsigned int grain)
+{
+    assert(m_NumPhases < ksMaxPhases);
+    assert(grain > 0);
+
+    Phase& phase = m_Phases[m_NumPhases];
+    phase.m_pName = pName;
+    phase.m_Grain = grain;
+    phase.m_NumDependencies = 0;
+    phase.m_NumDependents = 0;
+    phase.m_NumItems = 0;
+    phase.m_Last = Timing();
+    phase.m_TotalSpan = 0.0;
+    phase.m_TotalWait = 0.0;
+    phase.m_TotalBusy = 0.0;
+    phase.m_TotalJobs = 0.0;
+    phase.m_NumCritical = 0;
+
+    return m_NumPhases++;
+}
+
+void PhaseGraph::addDependency(unsigned int before, unsigned int after)
+{
+    assert((before < m_NumPhases) && (after < m_NumPhases));
+
+    // NOTE: A phase can only depend on one that was added before it, which 
+    //  keeps the graph from having any cycles in it.
+    assert(before < after);
+
+    Phase& phase = m_Phases[before];
+    phase.m_Dependents[phase.m_NumDependents++] = after;
+    ++m_Phases[after].m_NumDependencies;
+}
+
+void PhaseGraph::beginRun()
+{
+    for (unsigned int i = 0; i < m_NumPhases; ++i)
+    {
+        Phase& phase = m_Phases[i];
+        phase.m_DependenciesLeft = phase.m_NumDependencies;
+        phase.m_ItemsLeft = 0;
+        phase.m_NumJobs = 0;
+        phase.m_ReadyNs = 0;
+        phase.m_StartNs = -1;
+        phase.m_EndNs = 0;
+        phase.m_BusyNs = 0;
+        phase.m_NumItems = 0;
+    }
+}
+
+void PhaseGraph::endRun(long long runNs)
+{
+    for (unsigned int i = 0; i < m_NumPhases; ++i)
+    {
+        Phase& phase = m_Phases[i];
+        Timing& timing = phase.m_Last;
+        timing.m_Ready = (double)phase.m_ReadyNs * 1e-9;
+        timing.m_End = (double)phase.m_EndNs * 1e-9;
+        timing.m_Start = (phase.m_StartNs >= 0) ? ((double)phase.m_StartNs * 1e-9) : timing.m_End;
+        timing.m_Busy = (double)phase.m_BusyNs * 1e-9;
+        timing.m_NumJobs = phase.m_NumJobs;
+        timing.m_NumItems = phase.m_NumItems;
+
+        phase.m_TotalSpan += timing.m_End - timing.m_Ready;
+        phase.m_TotalWait += timing.m_Start - timing.m_Ready;
+        phase.m_TotalBusy += timing.m_Busy;
+        phase.m_TotalJobs += (double)timing.m_NumJobs;
+    }
+
+    unsigned int path[ksMaxPhases];
+    const unsigned int pathLength = getCriticalPath(path);
+    for (unsigned int i = 0; i < pathLength; ++i)
+    {
+        ++m_Phases[path[i]].m_NumCritical;
+    }
+
+    m_LastRunTime = (double)runNs * 1e-9;
+    m_TotalRunTime += m_LastRunTime;
+    ++m_NumRuns;
+}
+
+unsigned int PhaseGraph::getCriticalPath(unsigned int* pPhases) const
+{
+    if (m_NumPhases == 0)
+    {
+        return 0;
+    }
+
+    // Start from whatever finished last, and work backwards: each phase was 
+    //  waiting on whichever of its dependencies finished last.
+    unsigned int current = 0;
+    for (unsigned int i = 1; i < m_NumPhases; ++i)
+    {
+        if (m_Phases[i].m_Last.m_End > m_Phases[current].m_Last.m_End)
+        {
+            current = i;
+        }
+    }
+
+    unsigned int length = 0;
+    for (;;)
+    {
+        pPhases[length++] = current;
+
+        int latest = -1;
+        for (unsigned int i = 0; i < current; ++i)
+        {
+            const Phase& phase = m_Phases[i];
+            for (unsigned int d = 0; d < phase.m_NumDependents; ++d)
+            {
+                if ((phase.m_Dependents[d] == current) &&
+                    ((latest < 0) || (phase.m_Last.m_End > m_Phases[latest].m_Last.m_End)))
+                {
+                    latest = (int)i;
+                }
+            }
+        }
+
+        if (latest < 0)
+        {
+            break;
+        }
+        current = (unsigned int)latest;
+    }
+
+    // We found it back to front.
+    for (unsigned int i = 0; i < length / 2; ++i)
+    {
+        std::swap(pPhases[i], pPhases[length - 1 - i]);
+    }
+    return length;
+}
+
+void PhaseGraph::writeReport(std::ostream& out) const
+{
+    const std::ios::fmtflags oldFlags = out.flags();
+    const std::streamsize oldPrecision = out.precision();
+    const double numRuns = (double)std::max(1u, m_NumRuns);
+
+    out << "Phase graph: " << m_NumRuns << " runs, " << std::fixed << std::setprecision(4)
+        << (m_TotalRunTime * 1000.0 / numRuns) << " ms per run on average" << std::endl;
+    out << "  " << std::left << std::setw(14) << "phase" << std::setw(28) << "after"
+        << std::right << std::setw(10) << "span ms" << std::setw(10) << "wait ms" << std::setw(10) << "busy ms"
+        << std::setw(8) << "jobs" << std::setw(10) << "critical" << std::endl;
+
+    for (unsigned int i = 0; i < m_NumPhases; ++i)
+    {
+        const Phase& phase = m_Phases[i];
+
+        std::string after;
+        for (unsigned int j = 0; j < i; ++j)
+        {
+            const Phase& other = m_Phases[j];
+            for (unsigned int d = 0; d < other.m_NumDependents; ++d)
+            {
+                if (other.m_Dependents[d] == i)
+                {
+                    after += after.empty() ? "" : ", ";
+                    after += other.m_pName;
+                }
+            }
+        }
+
+        out << "  " << std::left << std::setw(14) << phase.m_pName << std::setw(28) << (after.empty() ? "-" : after)
+            << std::right << std::setprecision(4)
+            << std::setw(10) << (phase.m_TotalSpan * 1000.0 / numRuns)
+            << std::setw(10) << (phase.m_TotalWait * 1000.0 / numRuns)
+            << std::setw(10) << (phase.m_TotalBusy * 1000.0 / numRuns)
+            << std::setprecision(1)
+            << std::setw(8) << (phase.m_TotalJobs / numRuns)
+            << std::setw(9) << (100.0 * (double)phase.m_NumCritical / numRuns) << "%" << std::endl;
+    }
+
+    unsigned int path[ksMaxPhases];
+    const unsigned int pathLength = getCriticalPath(path);
+    out << "  Last critical path:";
+    for (unsigned int i = 0; i < pathLength; ++i)
+    {
+        out << (i ? " -> " : " ") << m_Phases[path[i]].m_pName;
+    }
+    out << std::endl;
+
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+}
+
+void PhaseGraph::resetTotals()
+{
+    for (unsigned int i = 0; i < m_NumPhases; ++i)
+    {
+        Phase& phase = m_Phases[i];
+        phase.m_TotalSpan = 0.0;
+        phase.m_TotalWait = 0.0;
+        phase.m_TotalBusy = 0.0;
+        phase.m_TotalJobs = 0.0;
+        phase.m_NumCritical = 0;
+    }
+
+    m_TotalRunTime = 0.0;
+    m_NumRuns = 0;
+}
@@ -0,0 +1,140 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <iosfwd>
+
+// The phases that a piece of work (such as a game tick) is broken into, and
+// which of them have to finish before which others can start.  A JobSystem
+// runs the graph: each phase starts as soon as everything it depends on is 
+// done, so phases that don't depend on each other run at the same time.
+//
+// Each phase is a loop over some number of items (entities, controllers...),
+// which the JobSystem splits up into jobs of at most the phase's grain items.
+// How many items there are is asked for when the phase becomes ready, since
+// earlier phases can change it (by placing mobs, for instance).
+//
+// The graph keeps track of how long every phase took, and reports the 
+// critical path - the chain of phases, each waiting on the one before it,
+// that decided how long the whole thing took.  Speeding up anything that 
+// isn't on it won't make a run any faster.
+class PhaseGraph
+{
+public:
+    static const unsigned int ksMaxPhases = 16;
+
+    // Does items [begin, end) of the given phase, on thread threadIndex.
+    typedef void (*RangeFunc)(void* pContext, unsigned int phase, unsigned int begin, unsigned int end, unsigned int threadIndex);
+
+    // Returns how many items the given phase has to do.
+    typedef unsigned int (*CountFunc)(void* pContext, unsigned int phase);
+
+    PhaseGraph(RangeFunc pRangeFunc, CountFunc pCountFunc, void* pContext);
+
+    // Returns the new phase's index.  The name isn't copied.
+    unsigned int addPhase(const char* pName, unsigned int grain);
+
+    // Phase after won't start until phase before is done.
+    void addDependency(unsigned int before, unsigned int after);
+
+    unsigned int getNumPhases() const { return m_NumPhases; }
+    const char* getName(unsigned int phase) const { return m_Phases[phase].m_pName; }
+
+    // When things happened during the last run, in seconds from its start.
+    //  Busy time is summed across every thread that worked on the phase, so 
+    //  it can be more than the phase's span.
+    struct Timing
+    {
+        double m_Ready;         // everything it depends on was done
+        double m_Start;         // its first job started
+        double m_End;           // its last job finished
+        double m_Busy;          // time spent in its jobs
+        unsigned int m_NumJobs;
+        unsigned int m_NumItems;
+    };
+    const Timing& getLastTiming(unsigned int phase) const { return m_Phases[phase].m_Last; }
+    double getLastRunTime() const { return m_LastRunTime; }
+
+    // Fills pPhases (which must have room for getNumPhases()) with the 
+    //  critical path of the last run, first phase first.  Returns its length.
+    unsigned int getCriticalPath(unsigned int* pPhases) const;
+
+    // Prints the graph, the average timings over every run since the last 
+    //  reset, and how often each phase was on the critical path.
+    void writeReport(std::ostream& out) const;
+    void resetTotals();
+
+private:
+    friend class JobSystem;
+
+    // Called by the JobSystem at the start and end of each run.  Times are in
+    //  nanoseconds from the start of the run.
+    void beginRun();
+    void endRun(long long runNs);
+
+    struct Phase
+    {
+        const char* m_pName;
+        unsigned int m_Grain;
+        unsigned int m_NumDependencies;
+        unsigned int m_NumDependents;
+        unsigned int m_Dependents[ksMaxPhases];
+
+        // While running
+        std::atomic<unsigned int> m_DependenciesLeft;
+        std::atomic<unsigned int> m_ItemsLeft;
+        std::atomic<unsigned int> m_NumJobs;
+        std::atomic<long long> m_ReadyNs;
+        std::atomic<long long> m_StartNs;
+        std::atomic<long long> m_EndNs;
+        std::atomic<long long> m_BusyNs;
+        unsigned int m_NumItems;
+
+        Timing m_Last;
+
+        // Summed over every run since the last reset
+        double m_TotalSpan;     // ready to end
+        double m_TotalWait;     // ready to start
+        double m_TotalBusy;
+        double m_TotalJobs;
+        unsigned int m_NumCritical;
+    };
+
+private:
+    RangeFunc m_pRangeFunc;
+    CountFunc m_pCountFunc;
+    void* m_pContext;
+
+    Phase m_Phases[ksMaxPhases];
+    unsigned int m_NumPhases;
+
+    double m_LastRunTime;
+    double m_TotalRunTime;
+    unsigned int m_NumRuns;
+
+private:
+    // DELIBERATELY UNDEFINED
+    PhaseGraph(const PhaseGraph& rhs);
+    PhaseGraph& operator=(const PhaseGraph& rhs);
+};
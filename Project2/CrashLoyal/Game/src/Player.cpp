@@ -26,13 +26,22 @@
 #include "Constants.h"
 #include "iController.h"
 #include "Game.h"
+#include "MatchArena.h"
 #include "Mob.h"
+#include "Profiler.h"
+#include "Scenario.h"
+#include "Snapshot.h"
 
-Player::Player(iController* pControl, bool bNorth)
-    : m_pControl(pControl)
+Player::Player(Game& game, iController* pControl, bool bNorth)
+    : m_Game(game)
+    , m_pControl(pControl)
     , m_bNorth(bNorth)
     , m_Elixir(capElixir(STARTING_ELIXIR))
+    , m_Buildings(game, bNorth, true)
+    , m_Mobs(game, bNorth, false)
 {
+    m_Mobs.reserve(ARENA_MOBS_PER_PLAYER);
+    m_PlacedMobs.reserve(ARENA_MOBS_PER_PLAYER);
     buildBuildings();
 
     // for now, all mob types are available.
@@ -48,9 +57,6 @@ Player::Player(iController* pControl, bool bNorth)
 Player::~Player()
 {
     delete m_pControl;      // it's safe to delete NULL
-    for (Entity* pBuilding : m_Buildings) delete pBuilding;
-    for (Entity* pMob : m_Mobs) delete pMob;
-    for (Entity* pMob : m_DeadMobs) delete pMob;
 }
 
 iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2& pos)
@@ -67,29 +73,21 @@ iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2
     // TODO: move this functionality somewhere shared.
     if ((tilePos.x <= 0) || (tilePos.x >= GAME_GRID_WIDTH))
     {
-        std::cout << "Invalid Location (X): (" << tilePos.x << ", " <<
-            tilePos.y << ")\n";
-        return InvalidX;
+        return placementFailed(type, tilePos, InvalidX);
     }
 
     if (m_bNorth)
     {
         if (tilePos.y >= RIVER_TOP_Y)
         {
-            std::cout << "Invalid Location (Y): (" << tilePos.x << ", " <<
-                tilePos.y << ")\n";
-
-            return InvalidY;
+            return placementFailed(type, tilePos, InvalidY);
         }
     }
     else
     {
         if (tilePos.y <= RIVER_BOT_Y)
         {
-            std::cout << "Invalid Location (Y): (" << tilePos.x << ", " <<
-                tilePos.y << ")\n";
-
-            return InvalidY;
+            return placementFailed(type, tilePos, InvalidY);
         }
     }
 
@@ -98,74 +96,100 @@ iPlayer::PlacementResult Player::placeMob(iEntityStats::MobType type, const Vec2
     const float cost = stats.getElixirCost();
     if (cost > m_Elixir)
     {
-        std::cout << "Insufficient Elixir: " << cost << " > " << m_Elixir <<
-            std::endl;
-
-        return InsufficientElixir;
+        return placementFailed(type, tilePos, InsufficientElixir);
     }
 
     // Make sure that the mob type is one that's currently available
     if (std::find(m_AvailableMobs.begin(), m_AvailableMobs.end(), type) == m_AvailableMobs.end())
     {
-        std::cout << "Mob type not available\n";
-
-        return MobTypeUnavailable;
+        return placementFailed(type, tilePos, MobTypeUnavailable);
     }
 
-    // Checks are done - make the mob.
+    // Checks are done - pay for the mob.  It's made once the controllers 
+    //  are done (see addPlacedMobs()).
     m_Elixir -= cost;
-    Mob* pMob = new Mob(stats, tilePos, m_bNorth);
-    m_Mobs.push_back(pMob);
+    m_Game.getReplay().recordPlacement(m_Game.getTickCount(), m_bNorth, type, tilePos);
+    PlacedMob placed = { type, tilePos };
+    m_PlacedMobs.push_back(placed);
 
     return Success;
 }
 
+iPlayer::PlacementResult Player::placementFailed(iEntityStats::MobType type, const Vec2& tilePos, PlacementResult result)
+{
+    m_Game.getCombatLog().logPlacementFailed(m_bNorth, type, tilePos, result, m_Elixir);
+    return result;
+}
+
+void Player::addPlacedMobs()
+{
+    CombatLog& log = m_Game.getCombatLog();
+    for (const PlacedMob& placed : m_PlacedMobs)
+    {
+        const unsigned int index = m_Mobs.add(iEntityStats::getStats(placed.m_Type), placed.m_Pos);
+        const Entity mob(m_Mobs, index);
+        log.logSpawn(mob);
+        m_Game.getEvents().publishSpawned(mob);
+    }
+    m_PlacedMobs.clear();
+}
+
 void Player::tick(float deltaTSec)
 {
     m_Elixir += deltaTSec * ELIXIR_PER_SECOND;
 
     if (m_pControl)
+    {
+        PROFILE_SCOPE("Controller");
         m_pControl->tick(deltaTSec);
-
-    for (Entity* pBuilding : m_Buildings) {
-        if (!pBuilding->isDead()) {
-            pBuilding->tick(deltaTSec);
-        }
     }
+}
 
-    for (Entity* m : m_Mobs) {
-        if (!m->isDead()) {
-            m->tick(deltaTSec);
-        }
-    }
+void Player::save(SnapshotWriter& writer) const
+{
+    writer.write(m_Elixir);
+    writer.writeVector(m_PlacedMobs);
+    m_Buildings.save(writer);
+    m_Mobs.save(writer);
+}
+
+bool Player::restore(SnapshotReader& reader, EntityStore* const* ppStores)
+{
+    return reader.read(m_Elixir) &&
+           reader.readVector(m_PlacedMobs) &&
+           m_Buildings.restore(reader, ppStores) &&
+           m_Mobs.restore(reader, ppStores);
+}
+
+void Player::loadScenario(const Scenario& scenario)
+{
+    m_PlacedMobs.clear();
 
-    // Move any mobs that died this tick into m_DeadMobs
-    size_t newIndex = 0;
-    for (size_t oldIndex = 0; oldIndex < m_Mobs.size(); ++oldIndex)
+    m_Buildings.clear();
+    buildBuildings();
+    assert(m_Buildings.size() == Scenario::NumTowers);
+    for (unsigned int i = 0; i < Scenario::NumTowers; ++i)
     {
-        Entity* pMob = m_Mobs[oldIndex];
-        if (!pMob->isDead())
-        {
-            Entity* pTemp = m_Mobs[newIndex];
-            m_Mobs[newIndex] = m_Mobs[oldIndex];
-            m_Mobs[oldIndex] = pTemp;
-            ++newIndex;
-        }
-        else
-        {
-            m_DeadMobs.push_back(m_Mobs[oldIndex]);
-        }
+        m_Buildings.m_Health[i] = std::max(0, scenario.getTowerHealth(m_bNorth, (Scenario::Tower)i));
     }
 
-    assert(newIndex <= m_Mobs.size());
-    m_Mobs.resize(newIndex);
+    const ScenarioMob* pMobs = scenario.getMobs(m_bNorth);
+    const unsigned int numMobs = scenario.getNumMobs(m_bNorth);
+    m_Mobs.clear();
+    m_Mobs.reserve(numMobs);
+    for (unsigned int i = 0; i < numMobs; ++i)
+    {
+        const ScenarioMob& mob = pMobs[i];
+        const unsigned int index = m_Mobs.add(iEntityStats::getStats((iEntityStats::MobType)mob.m_MobType), Vec2(mob.m_X, mob.m_Y));
+        m_Mobs.m_Health[index] = mob.m_Health;
+    }
 }
 
 iPlayer::EntityData Player::getBuilding(unsigned int i) const
 {
     if (i < m_Buildings.size())
     {
-        return m_Buildings[i]->getData();
+        return m_Buildings.getData(i);
     }
 
     return EntityData();
@@ -175,7 +199,7 @@ iPlayer::EntityData Player::getMob(unsigned int i) const
 {
     if (i < m_Mobs.size())
     {
-        return m_Mobs[i]->getData();
+        return m_Mobs.getData(i);
     }
 
     return EntityData();
@@ -185,7 +209,7 @@ iPlayer::EntityData Player::getOpponentBuilding(unsigned int i) const
 {
     if (i < GetOpponent().getBuildings().size())
     {
-        return GetOpponent().getBuildings()[i]->getData();
+        return GetOpponent().getBuildings().getData(i);
     }
 
     return EntityData();
@@ -195,12 +219,22 @@ iPlayer::EntityData Player::getOpponentMob(unsigned int i) const
 {
     if (i < GetOpponent().getMobs().size())
     {
-        return GetOpponent().getMobs()[i]->getData();
+        return GetOpponent().getMobs().getData(i);
     }
 
     return EntityData();
 }
 
+int Player::findMob(const EntityHandle& handle) const
+{
+    return m_Mobs.find(handle);
+}
+
+int Player::findOpponentMob(const EntityHandle& handle) const
+{
+    return GetOpponent().findMob(handle);
+}
+
 void Player::buildBuildings()
 {
     const iEntityStats& kingStats = iEntityStats::getBuildingStats(iEntityStats::King);
@@ -208,21 +242,21 @@ void Player::buildBuildings()
 
     if (m_bNorth)
     {
-        m_Buildings.push_back(new Building(kingStats, Vec2(KingX, NorthKingY), true));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessLeftX, NorthPrincessY), true));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessRightX, NorthPrincessY), true));
+        m_Buildings.add(kingStats, Vec2(KingX, NorthKingY));
+        m_Buildings.add(princessStats, Vec2(PrincessLeftX, NorthPrincessY));
+        m_Buildings.add(princessStats, Vec2(PrincessRightX, NorthPrincessY));
     }
     else
     {
-        m_Buildings.push_back(new Building(kingStats, Vec2(KingX, SouthKingY), false));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessLeftX, SouthPrincessY), false));
-        m_Buildings.push_back(new Building(princessStats, Vec2(PrincessRightX, SouthPrincessY), false));
+        m_Buildings.add(kingStats, Vec2(KingX, SouthKingY));
+        m_Buildings.add(princessStats, Vec2(PrincessLeftX, SouthPrincessY));
+        m_Buildings.add(princessStats, Vec2(PrincessRightX, SouthPrincessY));
     }
 }
 
 const Player& Player::GetOpponent() const
 {
-    const Player& opPlayer = Game::get().getPlayer(!m_bNorth);
+    const Player& opPlayer = m_Game.getPlayer(!m_bNorth);
     assert(&opPlayer != this);
     return opPlayer;
 }
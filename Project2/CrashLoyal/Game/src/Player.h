@@ -25,28 +25,52 @@
 #include "iPlayer.h"
 
 #include "Constants.h"
+#include "EntityStore.h"
 #include <algorithm>
 #include <assert.h>
 
+class Game;
 class iController;
-class Entity;
+class Scenario;
+class SnapshotReader;
+class SnapshotWriter;
 
 class Player : public iPlayer {
 public:
     // NOTE: we take ownership of the controller
-    explicit Player(iController* pControl, bool bNorth);
+    explicit Player(Game& game, iController* pControl, bool bNorth);
     virtual ~Player();
 
     virtual bool isNorth() const { return m_bNorth; }
 
     virtual float getElixir() const { return (float)m_Elixir; }
     virtual const std::vector<iEntityStats::MobType>& GetAvailableMobTypes() const { return m_AvailableMobs; }
+    // NOTE: The mob is paid for right away, but it isn't added until 
+    //  addPlacedMobs() is called, so it won't show up in getMob() until then.
+    //  That's what lets both controllers tick at once: neither one changes
+    //  anything that the other one can see.
     virtual PlacementResult placeMob(iEntityStats::MobType type, const Vec2& pos);
+    void addPlacedMobs();
 
+    // Gains elixir and ticks the controller.  Our buildings and mobs are 
+    //  ticked by Game::tick().
     void tick(float deltaTSec);
 
-    const std::vector<Entity*>& getBuildings() const { return m_Buildings; }
-    const std::vector<Entity*>& getMobs() const { return m_Mobs; }
+    // Our elixir, the mobs that we're waiting to add, and our stores (see 
+    //  EntityStore::save()).  Not our controller.
+    void save(SnapshotWriter& writer) const;
+    bool restore(SnapshotReader& reader, EntityStore* const* ppStores);
+
+    // Throws away our mobs (and any that are waiting to be added), and puts
+    //  our side of the scenario in their place.  Our towers are rebuilt with
+    //  the health that the scenario gives them.  The destroyed ones stay in 
+    //  our store at 0 health, just like towers destroyed during play.
+    void loadScenario(const Scenario& scenario);
+
+    EntityStore& getBuildings() { return m_Buildings; }
+    const EntityStore& getBuildings() const { return m_Buildings; }
+    EntityStore& getMobs() { return m_Mobs; }
+    const EntityStore& getMobs() const { return m_Mobs; }
 
     virtual unsigned int getNumBuildings() const { return m_Buildings.size(); }
     virtual EntityData getBuilding(unsigned int i) const;
@@ -60,14 +84,21 @@ public:
     virtual unsigned int getNumOpponentMobs() const { return GetOpponent().getNumMobs(); }
     virtual EntityData getOpponentMob(unsigned int i) const;
 
+    virtual int findMob(const EntityHandle& handle) const;
+    virtual int findOpponentMob(const EntityHandle& handle) const;
+
 private:
     void buildBuildings();
 
+    // Logs why placeMob() failed, and returns the result.
+    PlacementResult placementFailed(iEntityStats::MobType type, const Vec2& tilePos, PlacementResult result);
+
     const Player& GetOpponent() const;
 
     float capElixir(float e) const { return std::max(e, MAX_ELIXIR); }
 
 private:
+    Game& m_Game;
     iController* m_pControl;                // owned, may be NULL
 
     bool m_bNorth;
@@ -75,11 +106,14 @@ private:
 
     std::vector<iEntityStats::MobType> m_AvailableMobs;
 
-    std::vector<Entity*> m_Buildings;       // owned
-    std::vector<Entity*> m_Mobs;            // owned
+    struct PlacedMob
+    {
+        iEntityStats::MobType m_Type;
+        Vec2 m_Pos;
+    };
+    std::vector<PlacedMob> m_PlacedMobs;    // waiting for addPlacedMobs()
 
-    // When mobs die, we move them to this vector.  For now we just hang on to 
-    // them forever - we never delete them - so as to avoid memory issues.
-    std::vector<Entity*> m_DeadMobs;        // owned
+    EntityStore m_Buildings;
+    EntityStore m_Mobs;
 
 };
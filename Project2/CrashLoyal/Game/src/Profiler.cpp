@@ -0,0 +1,281 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> Profiler::s_bRecording(false);
+
+struct ProfileEvent
+{
+    const char* m_pName;
+    long long m_StartNs;
+    long long m_EndNs;
+};
+
+// One thread's events.  Only that thread adds to them, and they're only read
+//  once recording has stopped.
+struct ThreadEvents
+{
+    unsigned int m_ThreadIndex;             // its track in the trace
+    std::vector<ProfileEvent> m_Events;     // reserved up front, never grows
+    unsigned long long m_NumDropped;
+};
+
+// NOTE: The buffers are never freed, since the threads that filled them 
+//  (a game's job threads, say) are often gone by the time they're written out.
+static std::mutex s_ThreadsMutex;
+static std::vector<ThreadEvents*> s_Threads;
+static unsigned int s_EventsPerThread = Profiler::ksDefaultEventsPerThread;
+static long long s_StartNs = 0;
+
+static thread_local ThreadEvents* s_pThreadEvents = NULL;
+
+// The name that the tick histogram is made from (see Game::tick())
+static const char ksTickName[] = "Tick";
+
+static void resetEvents(ThreadEvents& events)
+{
+    if (events.m_Events.capacity() != s_EventsPerThread)
+    {
+        std::vector<ProfileEvent>().swap(events.m_Events);
+        events.m_Events.reserve(s_EventsPerThread);
+    }
+    events.m_Events.clear();
+    events.m_NumDropped = 0;
+}
+
+static ThreadEvents& registerThread()
+{
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+    ThreadEvents* pEvents = new ThreadEvents;
+    pEvents->m_ThreadIndex = (unsigned int)s_Threads.size();
+    resetEvents(*pEvents);
+    s_Threads.push_back(pEvents);
+    s_pThreadEvents = pEvents;
+    return *pEvents;
+}
+
+bool Profiler::isCompiledIn()
+{
+#ifdef CRASHLOYAL_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::start(unsigned int eventsPerThread)
+{
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+    s_EventsPerThread = std::max(1u, eventsPerThread);
+    for (ThreadEvents* pEvents : s_Threads)
+    {
+        resetEvents(*pEvents);
+    }
+    s_StartNs = getTimeNs();
+    s_bRecording = isCompiledIn();
+}
+
+void Profiler::stop()
+{
+    s_bRecording = false;
+}
+
+long long Profiler::getTimeNs()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* pName, long long startNs, long long endNs)
+{
+    ThreadEvents& events = s_pThreadEvents ? *s_pThreadEvents : registerThread();
+    if (events.m_Events.size() < events.m_Events.capacity())
+    {
+        ProfileEvent event = { pName, startNs, endNs };
+        events.m_Events.push_back(event);
+    }
+    else
+    {
+        ++events.m_NumDropped;
+    }
+}
+
+static void writeJsonString(std::ostream& out, const char* pString)
+{
+    out << '"';
+    for (const char* p = pString; *p; ++p)
+    {
+        if ((*p == '"') || (*p == '\\'))
+            out << '\\';
+        out << *p;
+    }
+    out << '"';
+}
+
+bool Profiler::writeChromeTrace(const char* pPath)
+{
+    std::ofstream out(pPath);
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+
+    // Times are in microseconds, from when recording started.
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+    bool bFirst = true;
+    for (const ThreadEvents* pEvents : s_Threads)
+    {
+        out << (bFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pEvents->m_ThreadIndex
+            << ",\"args\":{\"name\":\"Thread " << pEvents->m_ThreadIndex << "\"}}";
+        bFirst = false;
+
+        for (const ProfileEvent& event : pEvents->m_Events)
+        {
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.m_pName);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << pEvents->m_ThreadIndex
+                << ",\"ts\":" << ((double)(event.m_StartNs - s_StartNs) / 1000.0)
+                << ",\"dur\":" << ((double)(event.m_EndNs - event.m_StartNs) / 1000.0) << "}";
+        }
+    }
+    out << "\n]}\n";
+
+    return !!out;
+}
+
+// Nearest rank, from durations that are already sorted.
+static long long getPercentile(const std::vector<long long>& sortedNs, double fraction)
+{
+    size_t rank = (size_t)((fraction * (double)sortedNs.size()) + 0.999999);
+    rank = std::max((size_t)1, std::min(sortedNs.size(), rank));
+    return sortedNs[rank - 1];
+}
+
+static void writeTickHistogram(std::ostream& out, const std::vector<long long>& sortedNs)
+{
+    // One bucket per power of two microseconds
+    const unsigned int ksNumBuckets = 32;
+    unsigned int counts[ksNumBuckets] = {};
+    for (long long ns : sortedNs)
+    {
+        unsigned int bucket = 0;
+        for (long long us = ns / 1000; (us > 1) && (bucket + 1 < ksNumBuckets); us >>= 1)
+        {
+            ++bucket;
+        }
+        ++counts[bucket];
+    }
+
+    const unsigned int maxCount = *std::max_element(counts, counts + ksNumBuckets);
+    const unsigned int ksMaxBar = 50;
+    out << "Tick times:" << std::endl;
+    for (unsigned int bucket = 0; bucket < ksNumBuckets; ++bucket)
+    {
+        if (counts[bucket] == 0)
+            continue;
+
+        const unsigned long long lowUs = (bucket == 0) ? 0 : (1ull << bucket);
+        out << "  " << std::setw(8) << lowUs << " us+ " << std::setw(8) << counts[bucket] << " "
+            << std::string(std::max(1u, (counts[bucket] * ksMaxBar) / maxCount), '#') << std::endl;
+    }
+}
+
+void Profiler::writeReport(std::ostream& out)
+{
+    std::map<std::string, std::vector<long long>> durations;
+    unsigned long long numDropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+        for (const ThreadEvents* pEvents : s_Threads)
+        {
+            for (const ProfileEvent& event : pEvents->m_Events)
+            {
+                durations[event.m_pName].push_back(event.m_EndNs - event.m_StartNs);
+            }
+            numDropped += pEvents->m_NumDropped;
+        }
+    }
+
+    struct Line
+    {
+        const std::string* m_pName;
+        const std::vector<long long>* m_pSortedNs;
+        long long m_TotalNs;
+    };
+    std::vector<Line> lines;
+    for (auto& entry : durations)
+    {
+        std::sort(entry.second.begin(), entry.second.end());
+        long long totalNs = 0;
+        for (long long ns : entry.second)
+        {
+            totalNs += ns;
+        }
+        Line line = { &entry.first, &entry.second, totalNs };
+        lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end(), [](const Line& a, const Line& b) { return a.m_TotalNs > b.m_TotalNs; });
+
+    const std::ios::fmtflags oldFlags = out.flags();
+    const std::streamsize oldPrecision = out.precision();
+    out << std::fixed << std::setprecision(2);
+    out << "Profile (times in us):" << std::endl;
+    out << "  " << std::left << std::setw(24) << "Scope" << std::right << std::setw(10) << "Count" << std::setw(12) << "Total ms"
+        << std::setw(10) << "Mean" << std::setw(10) << "p50" << std::setw(10) << "p95" << std::setw(10) << "p99"
+        << std::setw(10) << "Max" << std::endl;
+    for (const Line& line : lines)
+    {
+        const std::vector<long long>& sortedNs = *line.m_pSortedNs;
+        out << "  " << std::left << std::setw(24) << *line.m_pName << std::right
+            << std::setw(10) << sortedNs.size()
+            << std::setw(12) << ((double)line.m_TotalNs / 1e6)
+            << std::setw(10) << ((double)line.m_TotalNs / 1e3 / (double)sortedNs.size())
+            << std::setw(10) << ((double)getPercentile(sortedNs, 0.50) / 1e3)
+            << std::setw(10) << ((double)getPercentile(sortedNs, 0.95) / 1e3)
+            << std::setw(10) << ((double)getPercentile(sortedNs, 0.99) / 1e3)
+            << std::setw(10) << ((double)sortedNs.back() / 1e3) << std::endl;
+    }
+    if (numDropped > 0)
+    {
+        out << "  (" << numDropped << " events didn't fit, and were dropped)" << std::endl;
+    }
+    out.flags(oldFlags);
+    out.precision(oldPrecision);
+
+    std::map<std::string, std::vector<long long>>::const_iterator ticks = durations.find(ksTickName);
+    if (ticks != durations.end())
+    {
+        writeTickHistogram(out, ticks->second);
+    }
+}
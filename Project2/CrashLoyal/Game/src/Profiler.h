@@ -0,0 +1,110 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <iosfwd>
+
+// Scoped timers for seeing where a tick (or a frame) goes.  Put 
+// PROFILE_SCOPE("Name") at the top of a block, and while the profiler is 
+// recording, every pass through the block is recorded as one event in the 
+// current thread's buffer: its name, and when it started and ended.  
+// Afterward the events can be written out as a Chrome trace (load it into 
+// chrome://tracing or ui.perfetto.dev to see every thread's timeline), or 
+// summed up into a report with the 50th, 95th and 99th percentile times for
+// each name.
+//
+// NOTE: PROFILE_SCOPE() compiles to nothing at all unless CRASHLOYAL_PROFILE
+//  is defined, so it can go in the hottest loops.  With it defined, a scope 
+//  that isn't recording costs one relaxed atomic load, and one that is 
+//  costs two clock reads and a copy into a buffer that nobody else touches.
+//  The names are kept as pointers, so they have to outlive the profiler 
+//  (string literals are fine).
+class Profiler
+{
+public:
+    static const unsigned int ksDefaultEventsPerThread = 1 << 20;
+
+    // False if CRASHLOYAL_PROFILE wasn't defined, in which case nothing is 
+    //  ever recorded.
+    static bool isCompiledIn();
+
+    // Throws away everything recorded so far, and starts recording.  Each 
+    //  thread gets room for this many events, and once it's full its new 
+    //  events are dropped (and counted).  Only call start() and stop() when
+    //  nothing that's being profiled is running.
+    static void start(unsigned int eventsPerThread = ksDefaultEventsPerThread);
+    static void stop();
+    static bool isRecording() { return s_bRecording.load(std::memory_order_relaxed); }
+
+    // For ProfileScope
+    static long long getTimeNs();
+    static void record(const char* pName, long long startNs, long long endNs);
+
+    // In the Trace Event format (JSON), one track per thread.  Returns false 
+    //  if the file couldn't be written.
+    static bool writeChromeTrace(const char* pPath);
+
+    // A line for each name: how many times it ran, the total time, and the 
+    //  mean, p50, p95, p99 and longest times, with the longest totals first.
+    //  Then a histogram of how long the ticks took.
+    static void writeReport(std::ostream& out);
+
+private:
+    static std::atomic<bool> s_bRecording;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* pName)
+        : m_pName(Profiler::isRecording() ? pName : NULL)
+        , m_StartNs(m_pName ? Profiler::getTimeNs() : 0)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_pName)
+        {
+            Profiler::record(m_pName, m_StartNs, Profiler::getTimeNs());
+        }
+    }
+
+private:
+    const char* m_pName;
+    long long m_StartNs;
+
+private:
+    // DELIBERATELY UNDEFINED
+    ProfileScope(const ProfileScope& rhs);
+    ProfileScope& operator=(const ProfileScope& rhs);
+};
+
+#ifdef CRASHLOYAL_PROFILE
+#define PROFILE_SCOPE_NAME_(line) profileScope##line
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_NAME_(line)
+#define PROFILE_SCOPE(pName) ProfileScope PROFILE_SCOPE_NAME(__LINE__)(pName)
+#else
+#define PROFILE_SCOPE(pName) ((void)0)
+#endif
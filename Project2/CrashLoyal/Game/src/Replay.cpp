@@ -0,0 +1,175 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Replay.h"
+
+#include "iPlayer.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char ksMagic[4] = { 'C', 'L', 'R', 'P' };
+
+// Enough for a long match, so that recording doesn't allocate as it ticks.
+static const unsigned int ksReservedInputs = 4096;
+
+Replay::Replay()
+    : m_bRecording(false)
+    , m_DeltaTSec(0.f)
+    , m_Seed(0)
+    , m_NumTicks(0)
+    , m_StateHash(0)
+{
+}
+
+void Replay::startRecording(float deltaTSec)
+{
+    m_bRecording = true;
+    m_DeltaTSec = deltaTSec;
+    m_Seed = 0;
+    m_NumTicks = 0;
+    m_StateHash = 0;
+    for (std::vector<ReplayInput>& inputs : m_Inputs)
+    {
+        inputs.clear();
+        inputs.reserve(ksReservedInputs);
+    }
+}
+
+void Replay::stopRecording(unsigned int numTicks, unsigned long long stateHash)
+{
+    m_bRecording = false;
+    m_NumTicks = numTicks;
+    m_StateHash = stateHash;
+}
+
+void Replay::recordPlacement(unsigned int tick, bool bNorth, iEntityStats::MobType type, const Vec2& pos)
+{
+    if (!m_bRecording)
+        return;
+
+    ReplayInput input;
+    memset(&input, 0, sizeof(input));
+    input.m_Tick = tick;
+    input.m_bNorth = bNorth;
+    input.m_MobType = (unsigned char)type;
+    input.m_X = pos.x;
+    input.m_Y = pos.y;
+    m_Inputs[bNorth ? 0 : 1].push_back(input);
+}
+
+bool Replay::save(const char* pPath) const
+{
+    FILE* pFile = fopen(pPath, "wb");
+    if (!pFile)
+        return false;
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_Magic, ksMagic, sizeof(ksMagic));
+    header.m_Version = ksVersion;
+    header.m_Seed = m_Seed;
+    header.m_DeltaTSec = m_DeltaTSec;
+    header.m_NumTicks = m_NumTicks;
+    header.m_NumInputs[0] = (unsigned int)m_Inputs[0].size();
+    header.m_NumInputs[1] = (unsigned int)m_Inputs[1].size();
+    header.m_StateHash = m_StateHash;
+
+    bool bOk = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+    for (const std::vector<ReplayInput>& inputs : m_Inputs)
+    {
+        if (bOk && !inputs.empty())
+        {
+            bOk = (fwrite(inputs.data(), sizeof(ReplayInput), inputs.size(), pFile) == inputs.size());
+        }
+    }
+
+    return (fclose(pFile) == 0) && bOk;
+}
+
+bool Replay::load(const char* pPath)
+{
+    FILE* pFile = fopen(pPath, "rb");
+    if (!pFile)
+        return false;
+
+    FileHeader header;
+    bool bOk = (fread(&header, sizeof(header), 1, pFile) == 1) &&
+               (memcmp(header.m_Magic, ksMagic, sizeof(ksMagic)) == 0) &&
+               (header.m_Version == ksVersion) &&
+               (header.m_DeltaTSec > 0.f);
+
+    for (unsigned int side = 0; bOk && (side < 2); ++side)
+    {
+        std::vector<ReplayInput>& inputs = m_Inputs[side];
+        inputs.resize(header.m_NumInputs[side]);
+        if (!inputs.empty())
+        {
+            bOk = (fread(inputs.data(), sizeof(ReplayInput), inputs.size(), pFile) == inputs.size());
+        }
+
+        for (unsigned int i = 0; bOk && (i < inputs.size()); ++i)
+        {
+            bOk = (inputs[i].m_MobType < iEntityStats::numMobTypes) &&
+                  ((inputs[i].m_bNorth != 0) == (side == 0)) &&
+                  ((i == 0) || (inputs[i - 1].m_Tick <= inputs[i].m_Tick));
+        }
+    }
+    fclose(pFile);
+
+    m_bRecording = false;
+    if (!bOk)
+    {
+        m_Inputs[0].clear();
+        m_Inputs[1].clear();
+        return false;
+    }
+
+    m_Seed = header.m_Seed;
+    m_DeltaTSec = header.m_DeltaTSec;
+    m_NumTicks = header.m_NumTicks;
+    m_StateHash = header.m_StateHash;
+    return true;
+}
+
+ReplayController::ReplayController(const Replay& replay, bool bNorth)
+    : m_Inputs(replay.getInputs(bNorth))
+    , m_Tick(0)
+    , m_Next(0)
+    , m_NumFailed(0)
+{
+}
+
+void ReplayController::tick(float /*deltaTSec*/)
+{
+    while ((m_Next < m_Inputs.size()) && (m_Inputs[m_Next].m_Tick <= m_Tick))
+    {
+        const ReplayInput& input = m_Inputs[m_Next++];
+        const iPlayer::PlacementResult result =
+            m_pPlayer->placeMob((iEntityStats::MobType)input.m_MobType, Vec2(input.m_X, input.m_Y));
+        if (result != iPlayer::Success)
+        {
+            ++m_NumFailed;
+        }
+    }
+    ++m_Tick;
+}
@@ -0,0 +1,121 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStats.h"
+#include "iController.h"
+#include "Vec2.h"
+
+#include <vector>
+
+// One successful placeMob() call.  These are written to replay files as they
+// are, so bump Replay::ksVersion if you change the layout.
+struct ReplayInput
+{
+    unsigned int m_Tick;            // the tick that it was placed during
+    unsigned char m_bNorth;
+    unsigned char m_MobType;        // iEntityStats::MobType
+    unsigned char m_Pad[2];
+    float m_X;                      // the tile center that it went to
+    float m_Y;
+};
+static_assert(sizeof(ReplayInput) == 16, "ReplayInput is part of the replay format");
+
+// Everything that went into a match, and nothing that came out of it.  The 
+// simulation is deterministic, so the mobs that each player placed (and 
+// when) are enough to play the whole match out again, and the hash of the 
+// state it ended in tells us whether the playback went the same way.
+//
+// NOTE: Each side's placements are kept separately, since the two 
+// controllers run at the same time.
+class Replay
+{
+public:
+    // 2: the state hash covers the whole snapshot
+    static const unsigned int ksVersion = 2;
+
+    Replay();
+
+    // Throws away anything that was recorded, and records from now on.
+    void startRecording(float deltaTSec);
+    void stopRecording(unsigned int numTicks, unsigned long long stateHash);
+    bool isRecording() const { return m_bRecording; }
+
+    // Only call this from bNorth's controller (see Player::placeMob()).
+    void recordPlacement(unsigned int tick, bool bNorth, iEntityStats::MobType type, const Vec2& pos);
+
+    // Returns false if the file couldn't be written (or read).
+    bool save(const char* pPath) const;
+    bool load(const char* pPath);
+
+    float getDeltaTSec() const { return m_DeltaTSec; }
+    unsigned int getSeed() const { return m_Seed; }
+    unsigned int getNumTicks() const { return m_NumTicks; }
+    unsigned long long getStateHash() const { return m_StateHash; }
+
+    // In the order that they were placed.
+    const std::vector<ReplayInput>& getInputs(bool bNorth) const { return m_Inputs[bNorth ? 0 : 1]; }
+
+private:
+    struct FileHeader
+    {
+        char m_Magic[4];
+        unsigned int m_Version;
+        unsigned int m_Seed;
+        float m_DeltaTSec;
+        unsigned int m_NumTicks;
+        unsigned int m_NumInputs[2];
+        unsigned int m_Reserved;
+        unsigned long long m_StateHash;
+    };
+
+private:
+    bool m_bRecording;
+    float m_DeltaTSec;
+    unsigned int m_Seed;            // nothing in the simulation is random yet, so this is always 0
+    unsigned int m_NumTicks;
+    unsigned long long m_StateHash;
+    std::vector<ReplayInput> m_Inputs[2];   // North, South
+};
+
+// Plays one side of a replay back: places the mobs that the player placed, on
+// the tick that it placed them.  Give it to a new game, since it counts ticks
+// from the first one that it sees.
+class ReplayController : public iController
+{
+public:
+    // NOTE: we don't own the replay, which has to outlive us.
+    ReplayController(const Replay& replay, bool bNorth);
+
+    virtual void tick(float deltaTSec);
+
+    // Placements that didn't work this time, which means the playback has 
+    //  gone differently from the match that was recorded.
+    unsigned int getNumFailed() const { return m_NumFailed; }
+
+private:
+    const std::vector<ReplayInput>& m_Inputs;
+    unsigned int m_Tick;
+    unsigned int m_Next;
+    unsigned int m_NumFailed;
+};
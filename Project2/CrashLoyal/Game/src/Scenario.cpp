@@ -0,0 +1,135 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Scenario.h"
+
+#include "Constants.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char ksMagic[4] = { 'C', 'L', 'S', 'C' };
+
+Scenario::Scenario()
+    : m_pHeader(NULL)
+    , m_pMobs(NULL)
+{
+}
+
+static bool isValidMob(const ScenarioMob& mob)
+{
+    return (mob.m_MobType < iEntityStats::numMobTypes) &&
+           (mob.m_X >= 0.f) && (mob.m_X <= (float)GAME_GRID_WIDTH) &&
+           (mob.m_Y >= 0.f) && (mob.m_Y <= (float)GAME_GRID_HEIGHT) &&
+           (mob.m_Health > 0);
+}
+
+bool Scenario::open(const char* pPath)
+{
+    close();
+    if (!m_File.open(pPath) || (m_File.getSize() < sizeof(FileHeader)))
+    {
+        m_File.close();
+        return false;
+    }
+
+    const FileHeader* pHeader = (const FileHeader*)m_File.getData();
+    const ScenarioMob* pMobs = (const ScenarioMob*)(m_File.getData() + sizeof(FileHeader));
+    const unsigned long long numMobs = (unsigned long long)pHeader->m_NumMobs[0] + pHeader->m_NumMobs[1];
+
+    bool bOk = (memcmp(pHeader->m_Magic, ksMagic, sizeof(ksMagic)) == 0) &&
+               (pHeader->m_Version == ksVersion) &&
+               (m_File.getSize() == sizeof(FileHeader) + (numMobs * sizeof(ScenarioMob))) &&
+               (pHeader->m_TowerHealth[0][KingTower] > 0) &&
+               (pHeader->m_TowerHealth[1][KingTower] > 0);
+
+    for (unsigned long long i = 0; bOk && (i < numMobs); ++i)
+    {
+        bOk = isValidMob(pMobs[i]);
+    }
+
+    if (!bOk)
+    {
+        m_File.close();
+        return false;
+    }
+
+    m_pHeader = pHeader;
+    m_pMobs = pMobs;
+    return true;
+}
+
+void Scenario::close()
+{
+    m_File.close();
+    m_pHeader = NULL;
+    m_pMobs = NULL;
+}
+
+ScenarioLayout::ScenarioLayout()
+{
+    const int kingHealth = iEntityStats::getBuildingStats(iEntityStats::King).getMaxHealth();
+    const int princessHealth = iEntityStats::getBuildingStats(iEntityStats::Princess).getMaxHealth();
+    for (int* pTowerHealth : m_TowerHealth)
+    {
+        pTowerHealth[Scenario::KingTower] = kingHealth;
+        pTowerHealth[Scenario::LeftPrincessTower] = princessHealth;
+        pTowerHealth[Scenario::RightPrincessTower] = princessHealth;
+    }
+}
+
+void ScenarioLayout::addMob(bool bNorth, iEntityStats::MobType type, const Vec2& pos)
+{
+    ScenarioMob mob;
+    memset(&mob, 0, sizeof(mob));
+    mob.m_MobType = (unsigned char)type;
+    mob.m_X = pos.x;
+    mob.m_Y = pos.y;
+    mob.m_Health = iEntityStats::getStats(type).getMaxHealth();
+    m_Mobs[bNorth ? 0 : 1].push_back(mob);
+}
+
+bool ScenarioLayout::save(const char* pPath) const
+{
+    FILE* pFile = fopen(pPath, "wb");
+    if (!pFile)
+        return false;
+
+    Scenario::FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.m_Magic, ksMagic, sizeof(ksMagic));
+    header.m_Version = Scenario::ksVersion;
+    header.m_NumMobs[0] = (unsigned int)m_Mobs[0].size();
+    header.m_NumMobs[1] = (unsigned int)m_Mobs[1].size();
+    memcpy(header.m_TowerHealth, m_TowerHealth, sizeof(m_TowerHealth));
+
+    bool bOk = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+    for (const std::vector<ScenarioMob>& mobs : m_Mobs)
+    {
+        if (bOk && !mobs.empty())
+        {
+            bOk = (fwrite(mobs.data(), sizeof(ScenarioMob), mobs.size(), pFile) == mobs.size());
+        }
+    }
+
+    return (fclose(pFile) == 0) && bOk;
+}
@@ -0,0 +1,121 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStats.h"
+#include "MappedFile.h"
+#include "Vec2.h"
+
+#include <vector>
+
+// One mob in a scenario file.  These are read straight out of the mapped file,
+// so bump Scenario::ksVersion if you change the layout.
+struct ScenarioMob
+{
+    unsigned char m_MobType;        // iEntityStats::MobType
+    unsigned char m_Pad[3];
+    float m_X;                      // in game coordinates
+    float m_Y;
+    int m_Health;
+};
+static_assert(sizeof(ScenarioMob) == 16, "ScenarioMob is part of the scenario format");
+
+// The state to start a match from: both sides' mobs (type, position and 
+//  health) and how much health their towers have left.  The file is mapped 
+//  rather than read, and the mobs are handed to the game straight out of it 
+//  (see Game::loadScenario()), so even a huge battle loads in a few 
+//  milliseconds.
+//
+// NOTE: Everything is checked when the file is opened, so once it's open, 
+//  it's safe to load as it is.
+class Scenario
+{
+public:
+    static const unsigned int ksVersion = 1;
+
+    // In the order that Player builds them.
+    enum Tower
+    {
+        KingTower,
+        LeftPrincessTower,
+        RightPrincessTower,
+
+        NumTowers
+    };
+
+    Scenario();
+
+    // Returns false if the file can't be mapped, or isn't a scenario from 
+    //  this version of the game, or has anything in it that the game can't 
+    //  start from (an unknown mob type, a mob off the map, a destroyed king 
+    //  tower...).
+    bool open(const char* pPath);
+    void close();
+    bool isOpen() const { return !!m_pHeader; }
+
+    int getTowerHealth(bool bNorth, Tower tower) const { return m_pHeader->m_TowerHealth[bNorth ? 0 : 1][tower]; }
+
+    unsigned int getNumMobs(bool bNorth) const { return m_pHeader->m_NumMobs[bNorth ? 0 : 1]; }
+    const ScenarioMob* getMobs(bool bNorth) const { return bNorth ? m_pMobs : (m_pMobs + getNumMobs(true)); }
+
+private:
+    friend struct ScenarioLayout;
+
+    // Followed by North's mobs, and then South's.
+    struct FileHeader
+    {
+        char m_Magic[4];
+        unsigned int m_Version;
+        unsigned int m_NumMobs[2];
+        int m_TowerHealth[2][NumTowers];
+        unsigned int m_Reserved[2];
+    };
+    static_assert((sizeof(FileHeader) % sizeof(float)) == 0, "The mobs have to be aligned in the mapped file");
+
+private:
+    MappedFile m_File;
+    const FileHeader* m_pHeader;
+    const ScenarioMob* m_pMobs;
+
+private:
+    // DELIBERATELY UNDEFINED
+    Scenario(const Scenario& rhs);
+    Scenario& operator=(const Scenario& rhs);
+};
+
+// A scenario that's being put together, to be saved as a scenario file.  It 
+// starts out with every tower at full health, and no mobs.
+struct ScenarioLayout
+{
+    ScenarioLayout();
+
+    // At full health.  Positions are in game coordinates.
+    void addMob(bool bNorth, iEntityStats::MobType type, const Vec2& pos);
+
+    // Returns false if the file couldn't be written.
+    bool save(const char* pPath) const;
+
+    // Indexed by Scenario::Tower.  Zero (or less) means it's been destroyed.
+    int m_TowerHealth[2][Scenario::NumTowers];    // North, South
+    std::vector<ScenarioMob> m_Mobs[2];
+};
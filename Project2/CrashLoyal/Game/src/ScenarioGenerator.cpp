@@ -0,0 +1,123 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ScenarioGenerator.h"
+
+#include "Constants.h"
+#include "Scenario.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+static const float ksTwoPi = 6.28318531f;
+
+// Keeps a mob on North's side of the river (positions are picked as if we 
+//  were North, and then flipped for South).
+static Vec2 clampToNorthSide(Vec2 pos)
+{
+    pos.x = std::max(0.5f, std::min((float)GAME_GRID_WIDTH - 0.5f, pos.x));
+    pos.y = std::max(0.5f, std::min((float)RIVER_TOP_Y - 0.5f, pos.y));
+    return pos;
+}
+
+static iEntityStats::MobType pickMobType(std::mt19937& random)
+{
+    std::uniform_int_distribution<int> types(0, iEntityStats::numMobTypes - 1);
+    return (iEntityStats::MobType)types(random);
+}
+
+static void addCrowd(ScenarioLayout& layout, std::mt19937& random, bool bNorth, unsigned int numMobs, const Vec2& center, float spread)
+{
+    std::normal_distribution<float> offset(0.f, spread);
+    for (unsigned int i = 0; i < numMobs; ++i)
+    {
+        const Vec2 pos = clampToNorthSide(Vec2(center.x + offset(random), center.y + offset(random)));
+        layout.addMob(bNorth, pickMobType(random), pos.Player2Game(bNorth));
+    }
+}
+
+static void generateBridge(ScenarioLayout& layout, std::mt19937& random, unsigned int numMobs)
+{
+    for (bool bNorth : { true, false })
+    {
+        const unsigned int numSideMobs = bNorth ? ((numMobs + 1) / 2) : (numMobs / 2);
+        const unsigned int numLeft = (numSideMobs + 1) / 2;
+        addCrowd(layout, random, bNorth, numLeft, Vec2(LEFT_BRIDGE_CENTER_X, RIVER_TOP_Y - 1.f), 1.f);
+        addCrowd(layout, random, bNorth, numSideMobs - numLeft, Vec2(RIGHT_BRIDGE_CENTER_X, RIVER_TOP_Y - 1.f), 1.f);
+    }
+}
+
+static void generateBlob(ScenarioLayout& layout, std::mt19937& random, unsigned int numMobs)
+{
+    for (bool bNorth : { true, false })
+    {
+        const unsigned int numSideMobs = bNorth ? ((numMobs + 1) / 2) : (numMobs / 2);
+        addCrowd(layout, random, bNorth, numSideMobs, Vec2(LEFT_BRIDGE_CENTER_X + 1.f, RIVER_TOP_Y - 4.f), 2.f);
+    }
+}
+
+static void generateSiege(ScenarioLayout& layout, std::mt19937& random, unsigned int numMobs)
+{
+    int* pNorthTowers = layout.m_TowerHealth[0];
+    pNorthTowers[Scenario::LeftPrincessTower] /= 3;
+    pNorthTowers[Scenario::RightPrincessTower] = 0;
+
+    const unsigned int numDefenders = numMobs / 11;
+    addCrowd(layout, random, true, numDefenders, Vec2(KingX, NorthKingY + 2.f), 1.5f);
+
+    // The attackers are in a ring around the tower, just outside of it.
+    const Vec2 tower(PrincessLeftX, NorthPrincessY);
+    std::uniform_real_distribution<float> angle(0.f, ksTwoPi);
+    std::uniform_real_distribution<float> dist(2.f, 5.f);
+    for (unsigned int i = numDefenders; i < numMobs; ++i)
+    {
+        const float a = angle(random);
+        const float d = dist(random);
+        const Vec2 pos = clampToNorthSide(Vec2(tower.x + (d * cosf(a)), tower.y + (d * sinf(a))));
+        layout.addMob(false, pickMobType(random), pos);
+    }
+}
+
+bool generateScenario(const char* pKind, unsigned int numMobs, unsigned int seed, ScenarioLayout& layout)
+{
+    std::mt19937 random(seed);
+    if (strcmp(pKind, "bridge") == 0)
+    {
+        generateBridge(layout, random, numMobs);
+    }
+    else if (strcmp(pKind, "blob") == 0)
+    {
+        generateBlob(layout, random, numMobs);
+    }
+    else if (strcmp(pKind, "siege") == 0)
+    {
+        generateSiege(layout, random, numMobs);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,37 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+struct ScenarioLayout;
+
+// Lays out a stress scenario with numMobs mobs (split between the two sides),
+// for saving as a scenario file.  The kinds are:
+//    bridge    Both sides piled up at the near ends of both bridges.
+//    blob      Each side in one dense blob in the left lane, facing each 
+//              other across the river.
+//    siege     South's army crowded around North's left princess tower, 
+//              which is down to a third of its health (the right one is 
+//              already gone), with a tenth as many defenders by the king.
+//  The mob types and positions are random, but the same seed always gives 
+//  the same layout.  Returns false if pKind isn't one of these.
+bool generateScenario(const char* pKind, unsigned int numMobs, unsigned int seed, ScenarioLayout& layout);
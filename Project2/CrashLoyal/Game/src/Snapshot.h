@@ -0,0 +1,147 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+// The whole state of a match, as a flat, versioned blob of bytes (see 
+// Game::saveSnapshot()).  A snapshot keeps its buffer when it's overwritten,
+// so saving into the same one over and over doesn't allocate once it's big
+// enough, and restoring from one reuses the room the game already has.
+//
+// NOTE: Controllers aren't part of the snapshot.  An AI that keeps its own 
+// state across ticks won't be put back along with the game.
+class Snapshot
+{
+public:
+    static const unsigned int ksVersion = 1;
+
+    Snapshot() {}
+
+    const unsigned char* getData() const { return m_Data.data(); }
+    size_t getSize() const { return m_Data.size(); }
+
+    // For snapshots that were kept somewhere else.
+    void assign(const unsigned char* pData, size_t size) { m_Data.assign(pData, pData + size); }
+
+private:
+    friend class SnapshotWriter;
+    friend class SnapshotReader;
+
+    std::vector<unsigned char> m_Data;
+};
+
+// Appends plain old data to a snapshot, which it empties first.
+class SnapshotWriter
+{
+public:
+    explicit SnapshotWriter(Snapshot& snapshot) : m_Data(snapshot.m_Data) { m_Data.clear(); }
+
+    void writeBytes(const void* pBytes, size_t size)
+    {
+        const size_t offset = m_Data.size();
+        m_Data.resize(offset + size);
+        if (size > 0)
+            memcpy(&m_Data[offset], pBytes, size);
+    }
+
+    template <typename T>
+    void write(const T& value) { writeBytes(&value, sizeof(T)); }
+
+    // Just the elements - the reader has to know how many there are.
+    template <typename T>
+    void writeElements(const std::vector<T>& values) { writeBytes(values.data(), values.size() * sizeof(T)); }
+
+    // The count, followed by the elements.
+    template <typename T>
+    void writeVector(const std::vector<T>& values)
+    {
+        write((unsigned int)values.size());
+        writeElements(values);
+    }
+
+    size_t getSize() const { return m_Data.size(); }
+
+    // For filling in a size (say) once we know what it is.
+    template <typename T>
+    void overwrite(size_t offset, const T& value) { memcpy(&m_Data[offset], &value, sizeof(T)); }
+
+private:
+    std::vector<unsigned char>& m_Data;
+};
+
+// Reads a snapshot back in the same order that it was written.  Once a read 
+// runs off the end, it and every read after it fail.
+class SnapshotReader
+{
+public:
+    explicit SnapshotReader(const Snapshot& snapshot) 
+        : m_pData(snapshot.m_Data.data()), m_Size(snapshot.m_Data.size()), m_Offset(0), m_bOk(true) {}
+
+    bool readBytes(void* pBytes, size_t size)
+    {
+        if (!m_bOk || (size > m_Size - m_Offset))
+        {
+            m_bOk = false;
+            return false;
+        }
+        if (size > 0)
+            memcpy(pBytes, m_pData + m_Offset, size);
+        m_Offset += size;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& value) { return readBytes(&value, sizeof(T)); }
+
+    // Resizes values to count, which reuses its capacity.
+    template <typename T>
+    bool readElements(std::vector<T>& values, unsigned int count)
+    {
+        if (!m_bOk || ((size_t)count * sizeof(T) > m_Size - m_Offset))
+        {
+            m_bOk = false;
+            return false;
+        }
+        values.resize(count);
+        return readBytes(values.data(), count * sizeof(T));
+    }
+
+    template <typename T>
+    bool readVector(std::vector<T>& values)
+    {
+        unsigned int count;
+        return read(count) && readElements(values, count);
+    }
+
+    bool isOk() const { return m_bOk; }
+    bool isAtEnd() const { return m_Offset == m_Size; }
+    size_t getSize() const { return m_Size; }
+
+private:
+    const unsigned char* m_pData;
+    size_t m_Size;
+    size_t m_Offset;
+    bool m_bOk;
+};
@@ -0,0 +1,244 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SpatialGrid.h"
+
+#include "AabbOverlap.h"
+#include "Constants.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_CellSize(cellSize)
+    , m_InvCellSize(1.f / cellSize)
+    , m_NumCellsX(std::max(1, (int)ceil((float)GAME_GRID_WIDTH / cellSize)))
+    , m_NumCellsY(std::max(1, (int)ceil((float)GAME_GRID_HEIGHT / cellSize)))
+{
+    m_CellStart.resize((m_NumCellsX * m_NumCellsY) + 1, 0);
+}
+
+void SpatialGrid::reserve(unsigned int numEntities)
+{
+    m_Entries.reserve(numEntities);
+    m_PackedEntries.reserve(numEntities);
+    m_PackedX.reserve(numEntities);
+    m_PackedY.reserve(numEntities);
+    m_PackedHalfSize.reserve(numEntities);
+}
+
+void SpatialGrid::clear()
+{
+    // clear() keeps the capacity, so once the grid has warmed up, rebuilding
+    //  it doesn't allocate.
+    m_Entries.clear();
+    std::fill(m_CellStart.begin(), m_CellStart.end(), 0);
+
+    m_PackedEntries.clear();
+    m_PackedX.clear();
+    m_PackedY.clear();
+    m_PackedHalfSize.clear();
+}
+
+unsigned int SpatialGrid::add(EntityStore& store, unsigned int storeIndex, const Vec2& pos)
+{
+    assert(storeIndex < store.size());
+
+    Entry entry;
+    entry.m_Ref = EntityRef(&store, (int)storeIndex);
+    entry.m_Pos = pos;
+    entry.m_HalfSize = store.getStatRow(storeIndex).m_HalfSize;
+    entry.m_Cell = getCell(pos);
+
+    const unsigned int index = (unsigned int)m_Entries.size();
+    m_Entries.push_back(entry);
+    return index;
+}
+
+void SpatialGrid::pack()
+{
+    // A counting sort by cell.  Count each cell's entities, turn the counts 
+    //  into where each cell starts, and then drop the entities in, in the 
+    //  order they were added.
+    const unsigned int numCells = (unsigned int)m_CellStart.size() - 1;
+    std::fill(m_CellStart.begin(), m_CellStart.end(), 0);
+    for (const Entry& entry : m_Entries)
+    {
+        ++m_CellStart[entry.m_Cell];
+    }
+
+    unsigned int start = 0;
+    for (unsigned int c = 0; c < numCells; ++c)
+    {
+        const unsigned int count = m_CellStart[c];
+        m_CellStart[c] = start;
+        start += count;
+    }
+    m_CellStart[numCells] = start;
+
+    const unsigned int numEntries = (unsigned int)m_Entries.size();
+    m_PackedEntries.resize(numEntries);
+    m_PackedX.resize(numEntries);
+    m_PackedY.resize(numEntries);
+    m_PackedHalfSize.resize(numEntries);
+    for (unsigned int index = 0; index < numEntries; ++index)
+    {
+        const Entry& entry = m_Entries[index];
+        const unsigned int packed = m_CellStart[entry.m_Cell]++;
+        m_PackedEntries[packed] = index;
+        m_PackedX[packed] = entry.m_Pos.x;
+        m_PackedY[packed] = entry.m_Pos.y;
+        m_PackedHalfSize[packed] = entry.m_HalfSize;
+    }
+
+    // Each cell's start has been moved along to where the next cell starts,
+    //  so shift them back.
+    for (unsigned int c = numCells - 1; c > 0; --c)
+    {
+        m_CellStart[c] = m_CellStart[c - 1];
+    }
+    m_CellStart[0] = 0;
+}
+
+unsigned int SpatialGrid::gatherOverlaps(const Vec2& pos, float halfSize, float maxHalfSize, std::vector<unsigned int>& indices) const
+{
+    assert(m_PackedEntries.size() == m_Entries.size());
+
+    // Anything we overlap has its center within our half size plus its half
+    //  size of our center.  Pad a little further so that rounding can't drop
+    //  something that's right on a cell boundary.
+    const float reach = halfSize + maxHalfSize + 0.01f;
+    const int minX = getCellX(pos.x - reach);
+    const int maxX = getCellX(pos.x + reach);
+    const int minY = getCellY(pos.y - reach);
+    const int maxY = getCellY(pos.y + reach);
+
+    unsigned int numTested = 0;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        // The cells from minX to maxX are next to each other in the packed 
+        //  arrays, so the whole row is tested in one go.
+        const unsigned int begin = m_CellStart[(y * m_NumCellsX) + minX];
+        const unsigned int end = m_CellStart[(y * m_NumCellsX) + maxX + 1];
+        if (begin == end)
+            continue;
+
+        numTested += end - begin;
+        const unsigned int first = (unsigned int)indices.size();
+        indices.resize(first + (end - begin));
+        const unsigned int numHits = findAabbOverlaps(&m_PackedX[begin], &m_PackedY[begin], &m_PackedHalfSize[begin], 
+                                                      end - begin, pos.x, pos.y, halfSize, &indices[first]);
+        for (unsigned int i = first; i < first + numHits; ++i)
+        {
+            indices[i] = m_PackedEntries[begin + indices[i]];
+        }
+        indices.resize(first + numHits);
+    }
+
+    return numTested;
+}
+
+void SpatialGrid::gatherCandidates(const Vec2& minPt, const Vec2& maxPt, std::vector<unsigned int>& indices) const
+{
+    const int minX = getCellX(minPt.x);
+    const int maxX = getCellX(maxPt.x);
+    const int minY = getCellY(minPt.y);
+    const int maxY = getCellY(maxPt.y);
+
+    assert(m_PackedEntries.size() == m_Entries.size());
+    for (int y = minY; y <= maxY; ++y)
+    {
+        // The row's cells are side by side, so they're gathered in one go.
+        const unsigned int begin = m_CellStart[(y * m_NumCellsX) + minX];
+        const unsigned int end = m_CellStart[(y * m_NumCellsX) + maxX + 1];
+        indices.insert(indices.end(), m_PackedEntries.begin() + begin, m_PackedEntries.begin() + end);
+    }
+}
+
+void SpatialGrid::gatherRing(const Vec2& pos, int ring, std::vector<unsigned int>& indices) const
+{
+    assert(ring >= 0);
+    const int centerX = getCellX(pos.x);
+    const int centerY = getCellY(pos.y);
+
+    const int minY = std::max(0, centerY - ring);
+    const int maxY = std::min(m_NumCellsY - 1, centerY + ring);
+    const int minX = std::max(0, centerX - ring);
+    const int maxX = std::min(m_NumCellsX - 1, centerX + ring);
+
+    assert(m_PackedEntries.size() == m_Entries.size());
+    for (int y = minY; y <= maxY; ++y)
+    {
+        // Only the first and last rows of the ring are full rows - the rest
+        //  just have a cell on each end.
+        const bool bFullRow = (y == centerY - ring) || (y == centerY + ring);
+        const int step = bFullRow ? 1 : (2 * ring);
+        for (int x = centerX - ring; x <= centerX + ring; x += std::max(1, step))
+        {
+            if ((x < minX) || (x > maxX))
+                continue;
+
+            const unsigned int cell = (y * m_NumCellsX) + x;
+            indices.insert(indices.end(), m_PackedEntries.begin() + m_CellStart[cell], m_PackedEntries.begin() + m_CellStart[cell + 1]);
+        }
+    }
+}
+
+int SpatialGrid::getMaxRing(const Vec2& pos) const
+{
+    const int x = getCellX(pos.x);
+    const int y = getCellY(pos.y);
+    return std::max(std::max(x, m_NumCellsX - 1 - x), std::max(y, m_NumCellsY - 1 - y));
+}
+
+void SpatialGrid::sortCandidates(std::vector<unsigned int>& indices)
+{
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+int SpatialGrid::getCellX(float x) const
+{
+    // Written so that NaN ends up in cell 0 rather than somewhere undefined.
+    const float f = x * m_InvCellSize;
+    if (!(f >= 1.f))
+        return 0;
+    if (f >= (float)(m_NumCellsX - 1))
+        return m_NumCellsX - 1;
+    return (int)f;
+}
+
+int SpatialGrid::getCellY(float y) const
+{
+    const float f = y * m_InvCellSize;
+    if (!(f >= 1.f))
+        return 0;
+    if (f >= (float)(m_NumCellsY - 1))
+        return m_NumCellsY - 1;
+    return (int)f;
+}
+
+int SpatialGrid::getCell(const Vec2& pos) const
+{
+    return (getCellY(pos.y) * m_NumCellsX) + getCellX(pos.x);
+}
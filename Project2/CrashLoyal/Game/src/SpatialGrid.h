@@ -0,0 +1,125 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "EntityStore.h"
+#include "Vec2.h"
+#include <vector>
+
+// A uniform grid over the arena, used to find the entities near a point 
+// without looking at every entity in the game.  Each entity is bucketed by 
+// the cell that contains its center.  Entities that are off the edge of the 
+// arena are put in the nearest edge cell, so queries never miss them.
+//
+// Most queries don't look at how big anything is.  Callers pad their query 
+// boxes by the largest size they care about, and then do their own exact test
+// on the candidates that come back.  gatherOverlaps() is the exception: it 
+// does the exact test itself, on a whole row of cells at a time.
+//
+// Every entity gets an index when it's added.  Candidates are returned as
+// these indices, sorted, so that callers visit them in the order they were
+// added - which lets the grid give exactly the same answers as a brute force
+// loop over the same entities in the same order.
+//
+// NOTE: Entities are bucketed by where they are when they're added, so the
+// grid has to be rebuilt after they move.  Queries don't change anything, so
+// any number of threads can run them at once.  The cells are laid out in 
+// flat arrays by pack(), so once the grid has room for every entity, 
+// rebuilding it doesn't allocate - no matter how the entities crowd together.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize);
+
+    void clear();
+
+    // Makes room for this many entities, so that adding them won't allocate.
+    void reserve(unsigned int numEntities);
+
+    // Returns the index assigned to the entity.  It's bucketed by its 
+    //  current position, unless it's given another one.
+    unsigned int add(EntityStore& store, unsigned int storeIndex) { return add(store, storeIndex, store.m_Pos[storeIndex]); }
+    unsigned int add(EntityStore& store, unsigned int storeIndex, const Vec2& pos);
+
+    // Lays the entities out cell by cell, with their positions and half sizes
+    //  in arrays of their own, so that the cells in each row are side by side
+    //  for findAabbOverlaps().  Call this after the last add() and before 
+    //  any query.
+    void pack();
+
+    unsigned int getNumEntities() const { return (unsigned int)m_Entries.size(); }
+    const EntityRef& getEntity(unsigned int index) const { return m_Entries[index].m_Ref; }
+
+    // Adds the index of every entity in every cell that overlaps the given 
+    //  box to indices.  Call sortCandidates() when you're done gathering.
+    void gatherCandidates(const Vec2& minPt, const Vec2& maxPt, std::vector<unsigned int>& indices) const;
+
+    // Adds the index of every entity in the cells that are exactly ring cells
+    //  away (in x or y) from the cell containing pos - ring 0 is just that 
+    //  cell, ring 1 is the 8 cells around it, and so on.  For nearest neighbor
+    //  searches: anything in ring r or beyond is more than getRingDist(r) 
+    //  from pos, and there's nothing beyond getMaxRing(pos).
+    void gatherRing(const Vec2& pos, int ring, std::vector<unsigned int>& indices) const;
+    float getRingDist(int ring) const { return (ring > 0) ? ((float)(ring - 1) * m_CellSize) : 0.f; }
+    int getMaxRing(const Vec2& pos) const;
+
+    // Puts the candidates in the order they were added, and removes duplicates
+    //  (which you can get by gathering from overlapping boxes).
+    static void sortCandidates(std::vector<unsigned int>& indices);
+
+    // Adds the index of every entity whose square overlaps the given one to
+    //  indices, tested exactly as aabbOverlaps() does (with the entity first).
+    //  Nothing in the grid can be bigger than maxHalfSize.  Call 
+    //  sortCandidates() when you're done gathering.  Returns how many entities
+    //  were tested.
+    unsigned int gatherOverlaps(const Vec2& pos, float halfSize, float maxHalfSize, std::vector<unsigned int>& indices) const;
+
+private:
+    int getCellX(float x) const;
+    int getCellY(float y) const;
+    int getCell(const Vec2& pos) const;
+
+    struct Entry
+    {
+        EntityRef m_Ref;
+        Vec2 m_Pos;
+        float m_HalfSize;
+        int m_Cell;
+    };
+
+private:
+    float m_CellSize;
+    float m_InvCellSize;
+    int m_NumCellsX;
+    int m_NumCellsY;
+
+    std::vector<Entry> m_Entries;
+
+    // Filled in by pack().  Cell c's entities are [m_CellStart[c], 
+    //  m_CellStart[c + 1]) in the other arrays.
+    std::vector<unsigned int> m_CellStart;
+    std::vector<unsigned int> m_PackedEntries;      // indices into m_Entries
+    std::vector<float> m_PackedX;
+    std::vector<float> m_PackedY;
+    std::vector<float> m_PackedHalfSize;
+};
@@ -0,0 +1,244 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Tournament.h"
+
+#include "Constants.h"
+#include "Controller_AI_KevinDill.h"
+#include "Game.h"
+#include "PerfCounters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+static iController* makeKevinDill() { return new Controller_AI_KevinDill; }
+static iController* makePassive() { return NULL; }
+
+// FinalProject: Add your controller here to have it play in tournaments.
+static const TournamentEntrant ksEntrants[] =
+{
+    { "KevinDill", &makeKevinDill },
+    { "Passive", &makePassive },
+};
+
+const TournamentEntrant* getTournamentEntrants(unsigned int& numEntrants)
+{
+    numEntrants = sizeof(ksEntrants) / sizeof(ksEntrants[0]);
+    return ksEntrants;
+}
+
+TournamentConfig::TournamentConfig()
+    : m_MatchesPerSide(100)
+    , m_MaxTicks((unsigned int)(180.f * SIM_HZ))    // a real match is 3 minutes
+    , m_DeltaTSec(1.f / SIM_HZ)
+    , m_NumThreads(0)
+{
+}
+
+namespace
+{
+    struct TournamentMatch
+    {
+        unsigned int m_Pairing;
+        bool m_bANorth;                 // rather than the pairing's B
+        unsigned int m_North;           // entrant indices
+        unsigned int m_South;
+
+        int m_GameOverState;            // see Game::getGameOverState()
+        unsigned int m_NumTicks;
+        double m_WallSec;
+        PerfCounters m_Counters;        // for the whole match
+    };
+
+    struct TournamentPairing
+    {
+        unsigned int m_A;
+        unsigned int m_B;
+    };
+
+    // What the threads share.  Each one takes the next match that nobody has
+    //  started, until there are none left.
+    struct TournamentState
+    {
+        const TournamentEntrant* m_pEntrants;
+        const TournamentConfig* m_pConfig;
+        std::vector<TournamentMatch> m_Matches;
+        std::atomic<unsigned int> m_NextMatch;
+    };
+}
+
+static void playMatch(const TournamentEntrant& north, const TournamentEntrant& south,
+                      const TournamentConfig& config, TournamentMatch& match)
+{
+    using namespace std::chrono;
+
+    const high_resolution_clock::time_point startTime = high_resolution_clock::now();
+
+    // There's a match on every thread already, so each one only gets one.
+    Game game(north.m_pMake(), south.m_pMake(), 1);
+    int gameOverState = 0;
+    unsigned int numTicks = 0;
+    while ((numTicks < config.m_MaxTicks) && (gameOverState == 0))
+    {
+        game.tick(config.m_DeltaTSec);
+        gameOverState = game.getGameOverState();
+        ++numTicks;
+    }
+
+    match.m_GameOverState = gameOverState;
+    match.m_NumTicks = numTicks;
+    match.m_WallSec = duration_cast<duration<double>>(high_resolution_clock::now() - startTime).count();
+    match.m_Counters = game.getMatchCounters();
+}
+
+static void tournamentThreadMain(TournamentState* pState)
+{
+    for (;;)
+    {
+        const unsigned int i = pState->m_NextMatch++;
+        if (i >= pState->m_Matches.size())
+            break;
+
+        TournamentMatch& match = pState->m_Matches[i];
+        playMatch(pState->m_pEntrants[match.m_North], pState->m_pEntrants[match.m_South], *pState->m_pConfig, match);
+    }
+}
+
+void runTournament(const TournamentEntrant* pEntrants, unsigned int numEntrants,
+                   const TournamentConfig& config, std::ostream& results, std::ostream& out)
+{
+    using namespace std::chrono;
+
+    // Every pair of entrants, or the one entrant against itself.
+    std::vector<TournamentPairing> pairings;
+    for (unsigned int a = 0; a < numEntrants; ++a)
+    {
+        for (unsigned int b = a + 1; b < numEntrants; ++b)
+        {
+            TournamentPairing pairing = { a, b };
+            pairings.push_back(pairing);
+        }
+    }
+    if (numEntrants == 1)
+    {
+        TournamentPairing pairing = { 0, 0 };
+        pairings.push_back(pairing);
+    }
+
+    TournamentState state;
+    state.m_pEntrants = pEntrants;
+    state.m_pConfig = &config;
+    state.m_NextMatch = 0;
+    for (unsigned int p = 0; p < pairings.size(); ++p)
+    {
+        for (unsigned int i = 0; i < 2 * config.m_MatchesPerSide; ++i)
+        {
+            const bool bANorth = (i < config.m_MatchesPerSide);
+            TournamentMatch match = {};
+            match.m_Pairing = p;
+            match.m_bANorth = bANorth;
+            match.m_North = bANorth ? pairings[p].m_A : pairings[p].m_B;
+            match.m_South = bANorth ? pairings[p].m_B : pairings[p].m_A;
+            state.m_Matches.push_back(match);
+        }
+    }
+
+    unsigned int numThreads = config.m_NumThreads ? config.m_NumThreads : std::thread::hardware_concurrency();
+    numThreads = std::max(1u, std::min(numThreads, (unsigned int)state.m_Matches.size()));
+
+    const high_resolution_clock::time_point startTime = high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numThreads; ++t)
+    {
+        threads.push_back(std::thread(&tournamentThreadMain, &state));
+    }
+    tournamentThreadMain(&state);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const double wallSec = duration_cast<duration<double>>(high_resolution_clock::now() - startTime).count();
+
+    results << "a\tb\tmatches\ta_wins\tb_wins\tdraws\ta_win_rate\ta_win_rate_north\ta_win_rate_south"
+               "\tavg_ticks\tavg_game_sec\tticks_per_sec";
+    for (unsigned int c = 0; c < NumPerfCounters; ++c)
+    {
+        results << "\t" << PerfCounters::getName((PerfCounter)c) << "_per_match";
+    }
+    results << std::endl;
+
+    unsigned long long totalTicks = 0;
+    for (unsigned int p = 0; p < pairings.size(); ++p)
+    {
+        unsigned int numMatches = 0;
+        unsigned int aWins[2] = { 0, 0 };       // as North, as South
+        unsigned int bWins = 0;
+        unsigned long long numTicks = 0;
+        double matchSec = 0.0;
+        PerfCounters counters;
+        for (const TournamentMatch& match : state.m_Matches)
+        {
+            if (match.m_Pairing != p)
+                continue;
+
+            const bool bNorthWon = (match.m_GameOverState > 0);
+            if (match.m_GameOverState != 0)
+            {
+                if (bNorthWon == match.m_bANorth)
+                    ++aWins[match.m_bANorth ? 0 : 1];
+                else
+                    ++bWins;
+            }
+
+            ++numMatches;
+            numTicks += match.m_NumTicks;
+            matchSec += match.m_WallSec;
+            counters.add(match.m_Counters);
+        }
+        totalTicks += numTicks;
+
+        const unsigned int perSide = config.m_MatchesPerSide;
+        const unsigned int draws = numMatches - aWins[0] - aWins[1] - bWins;
+        results << pEntrants[pairings[p].m_A].m_pName << "\t" << pEntrants[pairings[p].m_B].m_pName
+                << "\t" << numMatches << "\t" << (aWins[0] + aWins[1]) << "\t" << bWins << "\t" << draws
+                << "\t" << ((double)(aWins[0] + aWins[1]) / numMatches)
+                << "\t" << ((double)aWins[0] / perSide) << "\t" << ((double)aWins[1] / perSide)
+                << "\t" << ((double)numTicks / numMatches)
+                << "\t" << ((double)numTicks * config.m_DeltaTSec / numMatches)
+                << "\t" << ((matchSec > 0.0) ? (numTicks / matchSec) : 0.0);
+        for (unsigned int c = 0; c < NumPerfCounters; ++c)
+        {
+            results << "\t" << ((double)counters.get((PerfCounter)c) / numMatches);
+        }
+        results << std::endl;
+    }
+
+    out << "Tournament finished: " << state.m_Matches.size() << " matches on " << numThreads << " threads" << std::endl;
+    out << "  Wall time:        " << wallSec << " sec" << std::endl;
+    out << "  Matches per sec:  " << (state.m_Matches.size() / wallSec) << std::endl;
+    out << "  Ticks per sec:    " << (totalTicks / wallSec) << std::endl;
+}
@@ -0,0 +1,61 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <iosfwd>
+
+class iController;
+
+// A controller that can play in a tournament.  make() is called for every 
+// match that it plays, from whichever thread is playing it.
+struct TournamentEntrant
+{
+    const char* m_pName;
+    iController* (*m_pMake)();      // may return NULL, for a player that does nothing
+};
+
+// The controllers that we know how to make.
+const TournamentEntrant* getTournamentEntrants(unsigned int& numEntrants);
+
+struct TournamentConfig
+{
+    TournamentConfig();
+
+    unsigned int m_MatchesPerSide;  // each pairing plays this many with each entrant as North
+    unsigned int m_MaxTicks;        // a match that goes longer than this is a draw
+    float m_DeltaTSec;              // game time that passes on each tick
+    unsigned int m_NumThreads;      // matches played at once (0 means one per hardware thread)
+};
+
+// Plays every entrant against every other one (or against itself, if there's
+// only one), swapping sides half way through each pairing.  Each match is 
+// ticked on a single thread, and the matches are shared out over 
+// m_NumThreads threads.  When they're all done, the results for each pairing
+// are written to results as tab separated columns (with a header line), and 
+// a summary is printed to out.
+//
+// NOTE: The simulation is deterministic, so matches between the same two 
+// controllers on the same sides only go differently if the controllers do 
+// something random.
+void runTournament(const TournamentEntrant* pEntrants, unsigned int numEntrants,
+                   const TournamentConfig& config, std::ostream& results, std::ostream& out);
@@ -63,9 +63,12 @@ const float WAYPOINT_LEFT_X = LEFT_BRIDGE_CENTER_X;
 const float WAYPOINT_RIGHT_X = RIGHT_BRIDGE_CENTER_X;
 const float WAYPOINT_Y_INCREMENT = 2.f;
 
-// Tick limitations
+// Tick limitations.  The simulation always advances in fixed steps of 
+// 1 / SIM_HZ seconds, so results don't depend on the frame rate.  TICK_MAX is
+// the most game time we'll catch up on in a single frame after a stall.
 const float TICK_MIN = 0.05f;
 const float TICK_MAX = 0.2f;
+const float SIM_HZ = 1.f / TICK_MIN;
 
 // Elixir
 const float STARTING_ELIXIR = 8.f;
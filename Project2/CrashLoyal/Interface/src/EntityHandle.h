@@ -0,0 +1,45 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <climits>
+
+// Final Project: A handle names one mob or building for as long as it lives.
+// Indices (as in iPlayer::getMob(i)) shift around as mobs die, but a handle
+// doesn't - and once its entity is dead and gone, the handle simply stops 
+// finding anything, even if the memory it lived in has been reused for a new
+// mob.  That's what the generation is for: every time a slot is reused its 
+// generation goes up, so old handles to that slot no longer match.
+struct EntityHandle
+{
+    EntityHandle() : m_Slot(UINT_MAX), m_Generation(0) {}
+    EntityHandle(unsigned int slot, unsigned int generation) : m_Slot(slot), m_Generation(generation) {}
+
+    bool isNull() const { return m_Slot == UINT_MAX; }
+
+    bool operator==(const EntityHandle& rhs) const { return (m_Slot == rhs.m_Slot) && (m_Generation == rhs.m_Generation); }
+    bool operator!=(const EntityHandle& rhs) const { return !(*this == rhs); }
+
+    unsigned int m_Slot;
+    unsigned int m_Generation;
+};
@@ -0,0 +1,156 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// The actual stat values for every type of mob and building, as plain data.
+//
+// The iEntityStats interface (EntityStats.h) is what controllers should use.  
+// It's a thin wrapper around this table.  The game itself reads the table 
+// directly in its hot loops, so that looking up a mob's size or speed is an
+// array index rather than a virtual call.
+
+#include "EntityStats.h"
+
+#include <cfloat>
+#include <climits>
+
+// Mobs and buildings share one index space: mobs come first, in MobType 
+// order, followed by buildings in BuildingType order.
+const int NUM_STAT_TYPES = iEntityStats::numMobTypes + iEntityStats::numBuildingTypes;
+
+inline int getStatIndex(iEntityStats::MobType t) { return (int)t; }
+inline int getStatIndex(iEntityStats::BuildingType t) { return iEntityStats::numMobTypes + (int)t; }
+
+struct EntityStatRow
+{
+    iEntityStats::MobType m_MobType;            // InvalidMobType for buildings
+    iEntityStats::BuildingType m_BuildingType;  // InvalidBuildingType for mobs
+
+    float m_ElixirCost;                         // FLT_MAX for buildings
+    int m_MaxHealth;
+    float m_Speed;                              // FLT_MAX for buildings
+    float m_Size;
+    float m_Mass;                               // FLT_MAX for buildings
+    iEntityStats::TargetType m_TargetType;
+    float m_AttackRange;
+    iEntityStats::DamageType m_DamageType;
+    int m_Damage;
+    float m_AttackTime;
+    const char* m_Name;
+    const char* m_DisplayLetter;
+
+    // Derived from the values above
+    float m_HalfSize;                           // m_Size / 2
+    float m_DiagonalRadius;                     // half the diagonal of our square
+};
+
+// Fills in the derived values of a row
+constexpr EntityStatRow makeStatRow(iEntityStats::MobType mobType, iEntityStats::BuildingType buildingType,
+                                    float elixirCost, int maxHealth, float speed, float size, float mass,
+                                    iEntityStats::TargetType targetType, float attackRange,
+                                    iEntityStats::DamageType damageType, int damage, float attackTime,
+                                    const char* name, const char* displayLetter)
+{
+    // NOTE: 1.41421356f is (float)sqrt(2), which is what the collision code 
+    //  has always used.
+    return EntityStatRow{ mobType, buildingType, elixirCost, maxHealth, speed, size, mass,
+                          targetType, attackRange, damageType, damage, attackTime, name, displayLetter,
+                          size / 2.f, (1.41421356f * size) / 2.f };
+}
+
+// NOTE: This table must be in synch with the MobType and BuildingType enums
+//  (the static_asserts below will tell you if it isn't).
+constexpr EntityStatRow ENTITY_STATS[NUM_STAT_TYPES] =
+{
+    //          mob type                   building type                      elixir   health  speed    size   mass     targets                    range  damage type               dmg  attack time
+    makeStatRow(iEntityStats::Swordsman,   iEntityStats::InvalidBuildingType, 3.f,     1452,   4.f,     0.5f,  3.f,     iEntityStats::Any,         0.2f,  iEntityStats::Melee,      167, 1.2f, "Swordsman",      "S"),
+    makeStatRow(iEntityStats::Archer,      iEntityStats::InvalidBuildingType, 2.f,     216,    5.0f,    0.4f,  2.f,     iEntityStats::Any,         6.5f,  iEntityStats::Ranged,     100, 0.7f, "Archer",         "A"),
+    makeStatRow(iEntityStats::Giant,       iEntityStats::InvalidBuildingType, 5.f,     3275,   2.f,     0.9f,  8.f,     iEntityStats::Building,    .5f,   iEntityStats::Melee,      211, 1.5f, "Giant",          "G"),
+    makeStatRow(iEntityStats::InvalidMobType, iEntityStats::Princess,         FLT_MAX, 2534,   FLT_MAX, 2.5f,  FLT_MAX, iEntityStats::Any,         7.5f,  iEntityStats::Ranged,     90,  0.8f, "Princess Tower", "P"),
+    makeStatRow(iEntityStats::InvalidMobType, iEntityStats::King,             FLT_MAX, 4008,   FLT_MAX, 3.5f,  FLT_MAX, iEntityStats::Any,         7.f,   iEntityStats::Ranged,     90,  1.f,  "King Tower",     "K"),
+};
+
+static_assert(ENTITY_STATS[0].m_MobType == iEntityStats::Swordsman, "ENTITY_STATS is out of synch with MobType");
+static_assert(ENTITY_STATS[1].m_MobType == iEntityStats::Archer, "ENTITY_STATS is out of synch with MobType");
+static_assert(ENTITY_STATS[2].m_MobType == iEntityStats::Giant, "ENTITY_STATS is out of synch with MobType");
+static_assert(iEntityStats::numMobTypes == 3, "ENTITY_STATS is out of synch with MobType");
+static_assert(ENTITY_STATS[3].m_BuildingType == iEntityStats::Princess, "ENTITY_STATS is out of synch with BuildingType");
+static_assert(ENTITY_STATS[4].m_BuildingType == iEntityStats::King, "ENTITY_STATS is out of synch with BuildingType");
+static_assert(iEntityStats::numBuildingTypes == 2, "ENTITY_STATS is out of synch with BuildingType");
+
+// Values that depend on both the attacker (or mover) and the target, 
+// precomputed for every pair of stat types.
+struct EntityPairStats
+{
+    // (attacker size + target size) / 2 - how close our centers get when
+    //  we're standing right next to the target.
+    float m_CombinedHalfSize;
+
+    // The square of the distance between centers at which we can attack the
+    //  target.  Melee attackers get to add m_CombinedHalfSize to their range.
+    float m_AttackRangeSq;
+};
+
+struct EntityPairTable
+{
+    EntityPairStats m_Pairs[NUM_STAT_TYPES][NUM_STAT_TYPES];
+};
+
+constexpr EntityPairTable makePairTable()
+{
+    EntityPairTable table = {};
+    for (int i = 0; i < NUM_STAT_TYPES; ++i)
+    {
+        for (int j = 0; j < NUM_STAT_TYPES; ++j)
+        {
+            const EntityStatRow& attacker = ENTITY_STATS[i];
+            const EntityStatRow& target = ENTITY_STATS[j];
+
+            const float combined = (attacker.m_Size + target.m_Size) / 2.f;
+            float range = attacker.m_AttackRange;
+            if (attacker.m_DamageType == iEntityStats::Melee)
+            {
+                range += combined;
+            }
+
+            table.m_Pairs[i][j].m_CombinedHalfSize = combined;
+            table.m_Pairs[i][j].m_AttackRangeSq = range * range;
+        }
+    }
+    return table;
+}
+
+constexpr EntityPairTable ENTITY_PAIR_STATS = makePairTable();
+
+inline const EntityStatRow& getStatRow(int statIndex)
+{
+    assert((statIndex >= 0) && (statIndex < NUM_STAT_TYPES));
+    return ENTITY_STATS[statIndex];
+}
+
+inline const EntityPairStats& getPairStats(int attackerIndex, int targetIndex)
+{
+    assert((attackerIndex >= 0) && (attackerIndex < NUM_STAT_TYPES));
+    assert((targetIndex >= 0) && (targetIndex < NUM_STAT_TYPES));
+    return ENTITY_PAIR_STATS.m_Pairs[attackerIndex][targetIndex];
+}
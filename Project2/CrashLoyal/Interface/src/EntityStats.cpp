@@ -22,89 +22,52 @@
 
 #include "EntityStats.h"
 
-#include <assert.h>
-#include <unordered_map>
-
-class EntityStats_Swordsman : public iEntityStats_Mob
-{
-public:
-    virtual MobType getMobType() const { return Swordsman; }
-    virtual float getElixirCost() const { return 3.f; }
-    virtual int getMaxHealth() const { return 1452; }
-    virtual float getSpeed() const { return 4.f; }
-    virtual float getSize() const { return 0.5f; }
-    virtual float getMass() const { return 3.f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual float getAttackRange() const { return 0.2f; }
-    virtual DamageType getDamageType() const { return Melee; }
-    virtual int getDamage() const { return 167; }
-    virtual float getAttackTime() const { return 1.2f; }
-    virtual const char* getName() const { return "Swordsman"; }
-    virtual const char* getDisplayLetter() const { return "S"; }
-};
-
-class EntityStats_Archer : public iEntityStats_Mob
-{
-public:
-    virtual MobType getMobType() const { return Archer; }
-    virtual float getElixirCost() const { return 2.f; }
-    virtual int getMaxHealth() const { return 216; }
-    virtual float getSpeed() const { return 5.0f; }
-    virtual float getSize() const { return 0.4f; }
-    virtual float getMass() const { return 2.f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual float getAttackRange() const { return 6.5f; }
-    virtual DamageType getDamageType() const { return Ranged; }
-    virtual int getDamage() const { return 100; }
-    virtual float getAttackTime() const { return 0.7f; }
-    virtual const char* getName() const { return "Archer"; }
-    virtual const char* getDisplayLetter() const { return "A"; }
-};
+#include "EntityStatTable.h"
 
-class EntityStats_Giant : public iEntityStats_Mob
-{
-public:
-    virtual MobType getMobType() const { return Giant; }
-    virtual float getElixirCost() const { return 5.f; }
-    virtual int getMaxHealth() const { return 3275; }
-    virtual float getSpeed() const { return 2.f; }
-    virtual float getSize() const { return 0.9f; }
-    virtual float getMass() const { return 8.f; }
-    virtual TargetType getTargetType() const { return Building; }
-    virtual float getAttackRange() const { return .5f; }
-    virtual DamageType getDamageType() const { return Melee; }
-    virtual int getDamage() const { return 211; }
-    virtual float getAttackTime() const { return 1.5f; }
-    virtual const char* getName() const { return "Giant"; }
-    virtual const char* getDisplayLetter() const { return "G"; }
-};
+#include <assert.h>
 
-class EntityStats_Princess : public iEntityStats_Building
+// The stats for each type live in ENTITY_STATS (see EntityStatTable.h).  
+//  These just hand them out through the iEntityStats interface.
+class EntityStats_Mob : public iEntityStats_Mob
 {
 public:
-    virtual BuildingType getBuildingType() const { return Princess; }
-    virtual int getMaxHealth() const { return 2534; }
-    virtual float getSize() const { return 2.5f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual int getDamage() const { return 90; }
-    virtual float getAttackRange() const { return 7.5f; }
-    virtual float getAttackTime() const { return 0.8f; }
-    virtual const char* getName() const { return "Princess Tower"; }
-    virtual const char* getDisplayLetter() const { return "P"; }
+    explicit EntityStats_Mob(MobType t) : m_Row(ENTITY_STATS[getStatIndex(t)]) {}
+
+    virtual MobType getMobType() const { return m_Row.m_MobType; }
+    virtual float getElixirCost() const { return m_Row.m_ElixirCost; }
+    virtual int getMaxHealth() const { return m_Row.m_MaxHealth; }
+    virtual float getSpeed() const { return m_Row.m_Speed; }
+    virtual float getSize() const { return m_Row.m_Size; }
+    virtual float getMass() const { return m_Row.m_Mass; }
+    virtual TargetType getTargetType() const { return m_Row.m_TargetType; }
+    virtual float getAttackRange() const { return m_Row.m_AttackRange; }
+    virtual DamageType getDamageType() const { return m_Row.m_DamageType; }
+    virtual int getDamage() const { return m_Row.m_Damage; }
+    virtual float getAttackTime() const { return m_Row.m_AttackTime; }
+    virtual const char* getName() const { return m_Row.m_Name; }
+    virtual const char* getDisplayLetter() const { return m_Row.m_DisplayLetter; }
+
+private:
+    const EntityStatRow& m_Row;
 };
 
-class EntityStats_King : public iEntityStats_Building
+class EntityStats_Building : public iEntityStats_Building
 {
 public:
-    virtual BuildingType getBuildingType() const { return King; }
-    virtual int getMaxHealth() const { return 4008; }
-    virtual float getSize() const { return 3.5f; }
-    virtual TargetType getTargetType() const { return Any; }
-    virtual int getDamage() const { return 90; }
-    virtual float getAttackRange() const { return 7.f; }
-    virtual float getAttackTime() const { return 1.f; }
-    virtual const char* getName() const { return "King Tower"; }
-    virtual const char* getDisplayLetter() const { return "K"; }
+    explicit EntityStats_Building(BuildingType t) : m_Row(ENTITY_STATS[getStatIndex(t)]) {}
+
+    virtual BuildingType getBuildingType() const { return m_Row.m_BuildingType; }
+    virtual int getMaxHealth() const { return m_Row.m_MaxHealth; }
+    virtual float getSize() const { return m_Row.m_Size; }
+    virtual TargetType getTargetType() const { return m_Row.m_TargetType; }
+    virtual int getDamage() const { return m_Row.m_Damage; }
+    virtual float getAttackRange() const { return m_Row.m_AttackRange; }
+    virtual float getAttackTime() const { return m_Row.m_AttackTime; }
+    virtual const char* getName() const { return m_Row.m_Name; }
+    virtual const char* getDisplayLetter() const { return m_Row.m_DisplayLetter; }
+
+private:
+    const EntityStatRow& m_Row;
 };
 
 class EntityStats_Invalid : public iEntityStats_Mob
@@ -128,22 +91,16 @@ public:
 
 const iEntityStats& iEntityStats::getStats(MobType t)
 {
-    // NOTE: This vector must be in synch with the MobType enum (in the .h)
-    static std::vector<const iEntityStats*> sStats = { 
-        new EntityStats_Swordsman, 
-        new EntityStats_Archer,
-        new EntityStats_Giant
+    // NOTE: This array must be in synch with the MobType enum (in the .h)
+    static const EntityStats_Mob sStats[numMobTypes] = {
+        EntityStats_Mob(Swordsman),
+        EntityStats_Mob(Archer),
+        EntityStats_Mob(Giant)
     };
 
-    // If any of these fail, then your vector (above) is out of synch with the 
-    //  MobType enum (in the .h)... and bad things may ensue!
-    assert(sStats.size() == numMobTypes);
-    assert(!!sStats[t]);
-    assert(sStats[t]->getMobType() == t);
-
-    if ((size_t)t < sStats.size())
+    if ((size_t)t < numMobTypes)
     {
-        return *sStats[t];
+        return sStats[t];
     }
 
     static const EntityStats_Invalid ksInvalidStats;
@@ -153,24 +110,17 @@ const iEntityStats& iEntityStats::getStats(MobType t)
 
 const iEntityStats& iEntityStats::getBuildingStats(BuildingType t)
 {
-    // NOTE: This vector must be in synch with the MobType enum (in the .h)
-    static std::vector<const iEntityStats*> sStats = {
-        new EntityStats_Princess,
-        new EntityStats_King
+    // NOTE: This array must be in synch with the BuildingType enum (in the .h)
+    static const EntityStats_Building sStats[numBuildingTypes] = {
+        EntityStats_Building(Princess),
+        EntityStats_Building(King)
     };
 
-    // If any of these fail, then your vector (above) is out of synch with the 
-    //  MobType enum (in the .h)... and bad things may ensue!
-    assert(sStats.size() == numBuildingTypes);
-    assert(!!sStats[t]);
-    assert(sStats[t]->getBuildingType() == t);
-
-    if ((size_t)t < sStats.size())
+    if ((size_t)t < numBuildingTypes)
     {
-        return *sStats[t];
+        return sStats[t];
     }
 
     static const EntityStats_Invalid ksInvalidStats;
     return ksInvalidStats;
 }
-
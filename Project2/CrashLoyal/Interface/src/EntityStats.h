@@ -24,7 +24,7 @@
 
 // Final Project: The interfaces in this file let your AI determine what types 
 // of units exist, and what the characteristics are for each one.  The actual
-// values are in EntityStats.cpp. 
+// values are in EntityStatTable.h. 
 
 #include <assert.h>
 #include <limits>
@@ -33,8 +33,8 @@
 class iEntityStats
 {
 public:
-    // NOTE: This enum must be in synch with the vector (in 
-    // iEntityStats::getStats())
+    // NOTE: This enum must be in synch with ENTITY_STATS (in 
+    // EntityStatTable.h) and the array in iEntityStats::getStats()
     enum MobType
     {
         Swordsman,
@@ -46,8 +46,8 @@ public:
         InvalidMobType
     };
 
-    // NOTE: This enum must be in synch with the vector (in 
-    // iEntityStats::getBuildingStats())
+    // NOTE: This enum must be in synch with ENTITY_STATS (in 
+    // EntityStatTable.h) and the array in iEntityStats::getBuildingStats()
     enum BuildingType
     {
         Princess,
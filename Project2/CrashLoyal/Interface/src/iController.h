@@ -28,12 +28,13 @@
 // all of the pure virtual functions.  The game will call those functions when
 // it is time for the controler to do its work.
 
+#include "iGameEventListener.h"
+
 #include <assert.h>
-#include "SDL.h"
 
 class iPlayer;
 
-class iController
+class iController : public iGameEventListener
 {
 public:
     iController() : m_pPlayer(NULL) {}
@@ -46,6 +47,11 @@ public:
     // seconds, and in game time) since the last tick.
     virtual void tick(float deltaTSec) = 0;
 
+    // Final Project: Override this if you want to hear about spawns, damage,
+    // deaths and so on as they happen, rather than looking for them (see 
+    // GameEvent).  It's called after each tick, before your next tick().
+    virtual void onGameEvents(const GameEvent* /*pEvents*/, unsigned int /*numEvents*/) {}
+
 protected:
     iPlayer* m_pPlayer; // NOT owned, guaranteed to exist when tick() is called
 
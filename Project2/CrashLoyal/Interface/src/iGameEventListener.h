@@ -0,0 +1,80 @@
+// MIT License
+// 
+// Copyright(c) 2020 Arthur Bacon and Kevin Dill
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// 
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+// Final Project: Rather than looking through every entity each tick to find
+// out what changed, a controller can listen for these.  The game collects 
+// everything that happens during a tick, and hands the whole lot to each 
+// listener once the tick is over (see iController::onGameEvents()).
+
+#include "EntityHandle.h"
+#include "EntityStats.h"
+#include "Vec2.h"
+
+struct GameEvent
+{
+    enum Type
+    {
+        Spawned,            // m_Entity was placed at m_Pos
+        Damaged,            // m_Entity was hit by m_Other for m_Value damage
+        Died,               // m_Entity was killed by m_Other
+        TowerDestroyed,     // m_Entity (a building) was destroyed by m_Other, after it Died
+        GameOver,           // m_Value is the game over state (positive => North won)
+
+        NumTypes
+    };
+
+    Type m_Type;
+    unsigned int m_Tick;
+
+    // NOTE: Died and TowerDestroyed come in the tick that the entity's 
+    //  health ran out, so the handles are still good until the end of the 
+    //  tick - but by the time the listeners hear about it, a dead mob is 
+    //  gone.  GameOver has no entities.
+    bool m_bNorth;
+    const iEntityStats* m_pStats;
+    EntityHandle m_Entity;
+
+    bool m_bOtherNorth;
+    const iEntityStats* m_pOtherStats;  // NULL if there's no other entity
+    EntityHandle m_Other;
+
+    int m_Value;
+    Vec2 m_Pos;                         // where m_Entity was
+};
+
+class iGameEventListener
+{
+public:
+    iGameEventListener() {}
+    virtual ~iGameEventListener() {}
+
+    // Called after every tick, with everything that happened during it (in 
+    //  the order that it happened).  numEvents may be zero.
+    virtual void onGameEvents(const GameEvent* pEvents, unsigned int numEvents) = 0;
+
+private:
+    // DELIBERATELY UNDEFINED
+    iGameEventListener(const iGameEventListener& rhs);
+    iGameEventListener& operator=(const iGameEventListener& rhs);
+};
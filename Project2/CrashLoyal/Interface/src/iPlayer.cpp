@@ -32,11 +32,12 @@ iPlayer::EntityData::EntityData()
 {
 }
 
-iPlayer::EntityData::EntityData(const iEntityStats& stats, const int& health, const Vec2& pos)
+iPlayer::EntityData::EntityData(const iEntityStats& stats, const int& health, const Vec2& pos, const EntityHandle& handle)
 
     : m_Stats(stats)
     , m_Health(health)
     , m_Position(pos)
+    , m_Handle(handle)
 {
 }
 
@@ -44,6 +45,7 @@ iPlayer::EntityData::EntityData(const EntityData& rhs)
     : m_Stats(rhs.m_Stats)
     , m_Health(rhs.m_Health)
     , m_Position(rhs.m_Position)
+    , m_Handle(rhs.m_Handle)
 {
 }
 
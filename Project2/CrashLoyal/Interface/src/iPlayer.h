@@ -27,6 +27,7 @@
 // query into the state of your player and the opposing player, and to control 
 // your player.
 
+#include "EntityHandle.h"
 #include "EntityStats.h"
 #include "Vec2.h"
 #include <vector>
@@ -56,7 +57,10 @@ public:
     virtual const std::vector<iEntityStats::MobType>& GetAvailableMobTypes() const = 0;
 
     // Final Project: Your AI will call this function to place its mobs.  The
-    // return value will tell you whether it succeeded and why it failed.
+    // return value will tell you whether it succeeded and why it failed.  The
+    // elixir is spent right away, but the mob isn't added until every
+    // controller has ticked, so you won't see it in getMob() until your next
+    // tick.
     enum PlacementResult
     {
         Success = 0,
@@ -71,14 +75,18 @@ public:
     // the opposing player's entities.
     // NOTE: When getting buildings or mobs, you are responsible for ensuring you pass
     // in a valid index, but if you don't I'll create an invalid one for you.
+    // NOTE: The references in EntityData point into the player's entity storage,
+    // so don't hang onto one across a call to placeMob() or a game tick.  Keep 
+    // the handle instead, and use it to find the entity again later.
     struct EntityData
     {
         const iEntityStats& m_Stats;
         const int& m_Health;
         const Vec2& m_Position;
+        EntityHandle m_Handle;
 
         EntityData();
-        EntityData(const iEntityStats& stats, const int& health, const Vec2& pos);
+        EntityData(const iEntityStats& stats, const int& health, const Vec2& pos, const EntityHandle& handle);
         EntityData(const EntityData& rhs);
     };
 
@@ -92,6 +100,12 @@ public:
     virtual unsigned int getNumOpponentMobs() const = 0;
     virtual EntityData getOpponentMob(unsigned int i) const = 0;
 
+    // Final Project: These return the current index of the mob with the given
+    // handle, or -1 if it has died.  (Buildings are never removed, so their 
+    // indices don't change.)
+    virtual int findMob(const EntityHandle& handle) const = 0;
+    virtual int findOpponentMob(const EntityHandle& handle) const = 0;
+
 private:
     // DELIBERATELY UNDEFINED
     iPlayer(const iPlayer& rhs);